@@ -3,40 +3,235 @@
 #include <vector>
 #include <chrono>
 #include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <fstream>
+#include <string>
 #include "instrumentation.h"
 #include "board.h"
 #include "hueristics.h"
+#include "engine.h"
+#include "positions.h"
 // globals
-uint64_t g_nodesGenerated = 0;
-uint64_t g_nodesExpanded  = 0;
+thread_local uint64_t g_nodesGenerated = 0;
+thread_local uint64_t g_nodesExpanded  = 0;
 
-// refactor your existing main‐loop into this:
-char runGame(int minDepth, int maxDepth) {
-    // reset instrumentation
+// hardware counters (--perf): per-game totals land in gamePerf, and with
+// --perf-searches every search is also printed as it finishes
+bool perfEnabled = false, perfPerSearch = false;
+PerfSample gamePerf;
+
+// every move of every game, for the latency / branching-factor timeline
+struct MoveRecord {
+    int minD, maxD;        // the game's depth settings
+    int ply;
+    char side;
+    int depth;             // depth the search finished (0 for mcts)
+    uint64_t nodesGen, nodesExp;
+    double ms;
+    double ebf;            // effective branching factor, nodesGen^(1/depth)
+    int score;
+    int col;
+};
+vector<MoveRecord> moveLog;
+int gameMinD = 0, gameMaxD = 0, gamePly = 0;
+
+Move countedMove(Board &board, char player, const EngineSettings &settings) {
+    uint64_t gen0 = g_nodesGenerated, exp0 = g_nodesExpanded;
+    PerfSample before;
+    if (perfEnabled) before = perfCounters().read();
+    int score = 0, depth = 0;
+    auto t0 = chrono::steady_clock::now();
+    Move mv = engineMove(board, player, settings, &score, &depth);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    MoveRecord r{gameMinD, gameMaxD, gamePly++, player, depth,
+                 g_nodesGenerated - gen0, g_nodesExpanded - exp0, ms, 0.0, score, mv.col};
+    if (depth > 0 && r.nodesGen > 0) r.ebf = pow(double(r.nodesGen), 1.0 / depth);
+    moveLog.push_back(r);
+
+    if (!perfEnabled) return mv;
+    PerfSample d = perfDelta(before, perfCounters().read());
+    gamePerf += d;
+    if (perfPerSearch && d.valid)
+        cout << "search " << player << " depth " << settings.depth
+             << " cycles " << d.cycles << " instr " << d.instructions
+             << " ipc " << fixed << setprecision(2) << d.ipc()
+             << " l1dMiss " << d.l1dMisses << " llcMiss " << d.llcMisses
+             << " brMiss " << d.branchMisses << "\n";
+    return mv;
+}
+
+// counters summed over one depth combination's games
+void resetCounters(const EngineSettings &minSide, const EngineSettings &maxSide) {
     g_nodesGenerated = g_nodesExpanded = 0;
+    evalCache().resetStats();
+    transpositionTable().stats = TTStats();
+    threatCounters() = ThreatCounters();
+    gamePerf = PerfSample();
+    gameMinD = minSide.depth;
+    gameMaxD = maxSide.depth;
+}
+
+// refactor your existing main‐loop into this:
+char runGame(const EngineSettings &minSide, const EngineSettings &maxSide,
+             const Board &start, char toMove) {
+    gamePly = 0;
+    TraceSpan span("game", "game");
+    span.arg("minDepth", minSide.depth);
+    span.arg("maxDepth", maxSide.depth);
 
-    Board board;
+    Board board = start;
+    char player = toMove;
     Move mv;
+    uint64_t n0 = g_nodesGenerated;
     // alternate moves until game over
     while (!board.isFull() && !board.checkWin(MAX_PLAYER) && !board.checkWin(MIN_PLAYER)) {
-        // MAX turn
-        if (!board.checkWin(MIN_PLAYER)) {
-            mv = bestMove(board, maxDepth, MAX_PLAYER);
-            board.makeMove(mv.col, MAX_PLAYER);
-        }
-        // MIN turn
-        if (!board.checkWin(MAX_PLAYER)) {
-            mv = bestMove(board, minDepth, MIN_PLAYER);
-            board.makeMove(mv.col, MIN_PLAYER);
-        }
+        mv = countedMove(board, player, player == MAX_PLAYER ? maxSide : minSide);
+        board.makeMove(mv.col, player);
+        player = (player == MAX_PLAYER) ? MIN_PLAYER : MAX_PLAYER;
     }
+    span.arg("nodes", int64_t(g_nodesGenerated - n0));
     // return the winner
     if (board.checkWin(MAX_PLAYER)) return MAX_PLAYER;
     if (board.checkWin(MIN_PLAYER)) return MIN_PLAYER;
     return 'D';  // draw (if you ever allow)
 }
 
-int main() {
+double percentile(vector<double> v, double p) {
+    if (v.empty()) return 0;
+    sort(v.begin(), v.end());
+    return v[size_t(p * (v.size() - 1) + 0.5)];
+}
+
+// per-depth move latency and branching factor, plus the whole timeline as CSV
+void reportMoves(const string &csvPath) {
+    cout << "\nper-move latency by search depth\n" << left
+         << setw(8) << "depth" << setw(8) << "moves"
+         << setw(12) << "p50(ms)" << setw(12) << "p95(ms)" << setw(12) << "p99(ms)"
+         << setw(12) << "max(ms)" << setw(10) << "meanEBF" << "\n";
+    int maxDepth = 0;
+    for (auto &r : moveLog) maxDepth = max(maxDepth, r.depth);
+    for (int d = 0; d <= maxDepth; ++d) {
+        vector<double> ms;
+        double ebfSum = 0;
+        for (auto &r : moveLog)
+            if (r.depth == d) { ms.push_back(r.ms); ebfSum += r.ebf; }
+        if (ms.empty()) continue;
+        cout << setw(8) << (d ? to_string(d) : string("mcts")) << setw(8) << ms.size()
+             << fixed << setprecision(3)
+             << setw(12) << percentile(ms, 0.50) << setw(12) << percentile(ms, 0.95)
+             << setw(12) << percentile(ms, 0.99) << setw(12) << percentile(ms, 1.0)
+             << setw(10) << setprecision(2) << ebfSum / ms.size() << "\n";
+    }
+    if (csvPath.empty()) return;
+    ofstream csv(csvPath);
+    if (!csv) { cerr << "could not write " << csvPath << endl; return; }
+    csv << "minD,maxD,ply,side,depth,nodesGenerated,nodesExpanded,ms,ebf,score,col\n";
+    for (auto &r : moveLog)
+        csv << r.minD << ',' << r.maxD << ',' << r.ply << ',' << r.side << ',' << r.depth << ','
+            << r.nodesGen << ',' << r.nodesExp << ',' << fixed << setprecision(4) << r.ms << ','
+            << r.ebf << ',' << r.score << ',' << r.col << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    // optional arguments:
+    //   --eval-kb N    evaluation cache size in KB
+    //   --tt-mb N      transposition table size in MB (0 disables it)
+    //   --huge         back the transposition table with huge pages
+    //   --cache FILE   persistent position cache, loaded now and merged at exit
+    //   --book FILE    opening book from book-main, consulted before searching
+    //   --tablebase FILE  tablebase from tablebase-main (small boards only),
+    //                  answers every position it holds exactly
+    //   --max-engine E, --min-engine E
+    //                  minmax (default) or mcts; an mcts side ignores its depth
+    //   --playouts N, --mcts-ms N, --threads N
+    //                  mcts budgets per move (playouts and/or wall time) and threads
+    //   --perf         hardware counters per game (Linux perf_event_open)
+    //   --perf-searches  ... and per search
+    //   --trace FILE   chrome trace-event timeline of games, searches and root columns
+    //   --moves-csv FILE  every move (ply, depth, nodes, time, branching factor, score)
+    //   --threats N    at depth 0, follow immediate wins and forced blocks
+    //                  for up to N moves before evaluating
+    //   --dfpn N       before each minimax search, look for a forced win with
+    //                  df-pn within N nodes and play it if found
+    //   --slow-log FILE  append searches over --slow-ms MS or --slow-nodes N
+    //                  to FILE, for replay-main
+    //   --suite FILE   play every depth combination from each position of a
+    //                  suite (positions-main) instead of the empty board
+    size_t ttMB = 16;
+    bool hugePages = false;
+    string cacheFile, bookFile, tablebaseFile, movesCsv, slowLog, suitePath;
+    EngineSettings maxSide, minSide;
+    MctsLimits mcts;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--eval-kb" && i + 1 < argc)    evalCache().resize(atol(argv[++i]));
+        else if (arg == "--tt-mb" && i + 1 < argc) ttMB = atol(argv[++i]);
+        else if (arg == "--huge")                  hugePages = true;
+        else if (arg == "--cache" && i + 1 < argc) cacheFile = argv[++i];
+        else if (arg == "--book" && i + 1 < argc)  bookFile = argv[++i];
+        else if (arg == "--tablebase" && i + 1 < argc) tablebaseFile = argv[++i];
+        else if (arg == "--max-engine" && i + 1 < argc && parseEngineKind(argv[i+1], maxSide.kind)) ++i;
+        else if (arg == "--min-engine" && i + 1 < argc && parseEngineKind(argv[i+1], minSide.kind)) ++i;
+        else if (arg == "--playouts" && i + 1 < argc) mcts.playouts = atoll(argv[++i]);
+        else if (arg == "--mcts-ms" && i + 1 < argc)  mcts.timeMs = atof(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)  mcts.threads = atoi(argv[++i]);
+        else if (arg == "--perf")                     perfEnabled = true;
+        else if (arg == "--perf-searches")            perfEnabled = perfPerSearch = true;
+        else if (arg == "--trace" && i + 1 < argc)    traceRecorder().start(argv[++i]);
+        else if (arg == "--moves-csv" && i + 1 < argc) movesCsv = argv[++i];
+        else if (arg == "--dfpn" && i + 1 < argc)     dfpnPrecheck().nodes = atoll(argv[++i]);
+        else if (arg == "--threats" && i + 1 < argc)  maxSide.threats = minSide.threats = atoll(argv[++i]);
+        else if (arg == "--slow-log" && i + 1 < argc) slowLog = argv[++i];
+        else if (arg == "--slow-ms" && i + 1 < argc)  slowSearchLog().thresholdMs = atof(argv[++i]);
+        else if (arg == "--slow-nodes" && i + 1 < argc) slowSearchLog().thresholdNodes = atoll(argv[++i]);
+        else if (arg == "--suite" && i + 1 < argc)    suitePath = argv[++i];
+        else {
+            cerr << "Usage: " << argv[0]
+                 << " [--eval-kb N] [--tt-mb N] [--huge] [--cache FILE] [--book FILE]"
+                 << " [--tablebase FILE]"
+                 << " [--max-engine minmax|mcts] [--min-engine minmax|mcts]"
+                 << " [--playouts N] [--mcts-ms N] [--threads N]"
+                 << " [--perf] [--perf-searches] [--trace FILE] [--moves-csv FILE]"
+                 << " [--dfpn N] [--threats N]"
+                 << " [--slow-log FILE [--slow-ms MS] [--slow-nodes N]] [--suite FILE]" << endl;
+            return 1;
+        }
+    }
+    maxSide.mcts = minSide.mcts = mcts;
+    if (perfEnabled && !perfCounters().open())
+        cerr << "hardware counters unavailable, perf columns will read n/a" << endl;
+    transpositionTable().resize(ttMB, hugePages);
+    if (!cacheFile.empty() && !positionCache().open(cacheFile))
+        cerr << "ignoring unreadable position cache " << cacheFile << endl;
+    if (!bookFile.empty() && !openingBook().open(bookFile))
+        cerr << "ignoring unreadable opening book " << bookFile << endl;
+    if (!slowLog.empty() && !slowSearchLog().open(slowLog))
+        cerr << "cannot append to slow-search log " << slowLog << endl;
+    if (!tablebaseFile.empty() && !tablebase().open(tablebaseFile))
+        cerr << "ignoring tablebase " << tablebaseFile << " (unreadable or not "
+             << ROWS << "x" << COLS << ")" << endl;
+
+    vector<pair<Board,char>> starts;
+    if (suitePath.empty()) {
+        starts.push_back({Board(), MAX_PLAYER});
+    } else {
+        SuiteHeader h;
+        vector<uint64_t> keys;
+        if (!readSuite(suitePath, h, keys) || keys.empty()) {
+            cerr << "cannot read suite " << suitePath << " (or it is empty)" << endl;
+            return 1;
+        }
+        for (uint64_t key : keys) {
+            BitPosition pos = positionFromKey(key);
+            starts.push_back({boardFromPosition(pos), playerToMove(pos)});
+        }
+        cout << "playing each depth combination from the " << starts.size()
+             << " positions of " << suitePath << "\n";
+    }
+    bool suite = !suitePath.empty();
+
     vector<pair<int,int>> combos = {
         {2,2},{2,4},{2,8},
         {4,2},{4,4},{4,8},
@@ -46,22 +241,42 @@ int main() {
 
     for (auto [minD,maxD] : combos) {
 		// start the timer, run the game, stop the timer
+        minSide.depth = minD;
+        maxSide.depth = maxD;
+        resetCounters(minSide, maxSide);
+        double cpu0 = cpuTimeMs();
         auto t0 = chrono::high_resolution_clock::now();
-        char winner = runGame(minD, maxD);
+        char winner = 'D';
+        int maxWins = 0, minWins = 0;
+        for (auto &[start, toMove] : starts) {
+            winner = runGame(minSide, maxSide, start, toMove);
+            maxWins += winner == MAX_PLAYER;
+            minWins += winner == MIN_PLAYER;
+        }
         auto t1 = chrono::high_resolution_clock::now();
+        double cpuMs = cpuTimeMs() - cpu0;
 
 		// calculate game runtime duration
         double ms = chrono::duration<double, milli>(t1-t0).count();
 		
 		// calculate peak RSS memory
         long memKB = peakRSS_KB();
+        const TranspositionTable &tt = transpositionTable();
 
         results.push_back({minD, maxD,
                            g_nodesGenerated,
                            g_nodesExpanded,
                            ms,
+                           cpuMs,
                            memKB,
-                           winner});
+                           evalCache().hitRate(),
+                           tt.stats.probes ? double(tt.stats.hits) / tt.stats.probes : 0.0,
+                           tt.fillRate(),
+                           tt.stats.depthReplaced + tt.stats.alwaysReplaced,
+                           winner,
+                           gamePerf,
+                           threatCounters(),
+                           int(starts.size()), maxWins, minWins});
     }
 
 		// eloquent table output
@@ -71,9 +286,27 @@ int main() {
 				  << setw(18) << "nodesGenerated"
 				  << setw(18) << "nodesExpanded"
 				  << setw(12) << "time(s)"
+				  << setw(10) << "cpu(s)"
 				  << setw(10) << "mem(KB)"
-				  << setw(8)  << "winner"
-				  << "\n";
+				  << setw(10) << "evalHit%"
+				  << setw(8)  << "ttHit%"
+				  << setw(8)  << "ttFill%"
+				  << setw(12) << "ttReplaced"
+				  << setw(suite ? 12 : 8) << (suite ? "X-D-O" : "winner");
+		bool threats = maxSide.threats || minSide.threats;
+		if (threats)
+			cout << setw(14) << "threatLeaves"
+				 << setw(12) << "extended"
+				 << setw(14) << "threatNodes"
+				 << setw(10) << "cutShort";
+		if (perfEnabled)
+			cout << setw(16) << "cycles"
+				 << setw(16) << "instructions"
+				 << setw(6)  << "IPC"
+				 << setw(14) << "L1dMisses"
+				 << setw(14) << "LLCMisses"
+				 << setw(14) << "brMisses";
+		cout << "\n";
 
 		for (auto &m : results) {
 			cout << left
@@ -82,9 +315,52 @@ int main() {
 					  << setw(18) << m.nodesGen
 					  << setw(18) << m.nodesExp
 					  << setw(12) << fixed << setprecision(3) << (m.elapsedMs/1000.0)
+					  << setw(10) << (m.cpuMs/1000.0)
 					  << setw(10) << m.memKB
-					  << setw(8)  << m.winner
-					  << "\n";
+					  << setw(10) << setprecision(1) << (m.evalHitRate*100.0)
+					  << setw(8)  << (m.ttHitRate*100.0)
+					  << setw(8)  << (m.ttFillRate*100.0)
+					  << setw(12) << m.ttReplaced
+					  << setw(suite ? 12 : 8);
+			if (suite)
+				cout << to_string(m.maxWins) + "-" + to_string(m.games - m.maxWins - m.minWins)
+				        + "-" + to_string(m.minWins);
+			else
+				cout << m.winner;
+			if (threats)
+				cout << setw(14) << m.threats.leaves
+					 << setw(12) << m.threats.extended
+					 << setw(14) << m.threats.nodes
+					 << setw(10) << m.threats.budgetHits;
+			if (perfEnabled && m.perf.valid)
+				cout << setw(16) << m.perf.cycles
+					 << setw(16) << m.perf.instructions
+					 << setw(6)  << setprecision(2) << m.perf.ipc()
+					 << setw(14) << m.perf.l1dMisses
+					 << setw(14) << m.perf.llcMisses
+					 << setw(14) << m.perf.branchMisses;
+			else if (perfEnabled)
+				cout << setw(16) << "n/a" << setw(16) << "n/a" << setw(6) << "n/a"
+					 << setw(14) << "n/a" << setw(14) << "n/a" << setw(14) << "n/a";
+			cout << "\n";
 		}
+
+    reportMoves(movesCsv);
+
+    if (openingBook().enabled())
+        cout << "opening book: " << openingBook().size() << " positions, "
+             << openingBook().hits.load() << " of " << openingBook().probes.load()
+             << " root probes answered\n";
+    if (tablebase().enabled())
+        cout << "tablebase: " << tablebase().positions() << " positions, "
+             << tablebase().hits.load() << " of " << tablebase().probes.load() << " probes hit\n";
+    if (positionCache().enabled()) {
+        size_t added = positionCache().pendingCount();
+        if (positionCache().save())
+            cout << "position cache: " << positionCache().mappedCount()
+                 << " positions (" << added << " new)\n";
+        else
+            cerr << "could not save position cache " << cacheFile << endl;
+    }
     return 0;
 }
@@ -0,0 +1,94 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include "instrumentation.h"
+#include "board.h"
+#include "hueristics.h"
+#include "batcheval.h"
+// globals
+thread_local uint64_t g_nodesGenerated = 0;
+thread_local uint64_t g_nodesExpanded  = 0;
+
+// benchmark and exactness check for batcheval.h: a reproducible set of
+// positions from random games (won positions included) is scored by
+// evaluateWithCenterBias one board at a time, then by the scalar and AVX2
+// batch paths. every batch score must equal the board evaluator's.
+
+vector<Board> randomPositions(size_t count, uint32_t seed) {
+    vector<Board> out;
+    out.reserve(count);
+    uint32_t rng = seed ? seed : 1;
+    auto next = [&]() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; };
+    while (out.size() < count) {
+        Board board;
+        char player = MAX_PLAYER;
+        int stopAt = int(next() % (ROWS * COLS + 1));
+        for (int ply = 0; ply < stopAt && !board.isFull(); ++ply) {
+            int c;
+            do c = int(next() % COLS); while (!board.isValidMove(c));
+            board.makeMove(c, player);
+            if (board.checkWin(player)) break;
+            player = (player == MAX_PLAYER) ? MIN_PLAYER : MAX_PLAYER;
+        }
+        out.push_back(board);
+    }
+    return out;
+}
+
+template <class Fn>
+double bestMs(int reps, Fn fn) {
+    double best = 1e30;
+    for (int r = 0; r < reps; ++r) {
+        auto t0 = chrono::steady_clock::now();
+        fn();
+        best = min(best, chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count());
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = (argc > 1) ? size_t(atol(argv[1])) : 200000;
+    int reps     = (argc > 2) ? atoi(argv[2]) : 5;
+    vector<Board> boards = randomPositions(count, 12345);
+    BoardBatch batch;
+    batch.reserve(boards.size());
+    for (const Board &b : boards) batch.add(b);
+
+    vector<int> ref(count), scalar(count), vec(count);
+    double refMs = bestMs(reps, [&] {
+        for (size_t i = 0; i < count; ++i) ref[i] = evaluateWithCenterBias(boards[i]);
+    });
+    double scalarMs = bestMs(reps, [&] { evaluateBatchScalar(batch, scalar.data()); });
+
+    bool avx2 = batchEvalHasAvx2();
+    double vecMs = 0;
+#ifdef BATCHEVAL_X86
+    if (avx2) vecMs = bestMs(reps, [&] { evaluateBatchAvx2(batch, vec.data()); });
+#endif
+
+    size_t wins = 0, scalarBad = 0, vecBad = 0;
+    for (size_t i = 0; i < count; ++i) {
+        wins += (ref[i] == 100000 || ref[i] == -100000);
+        scalarBad += (scalar[i] != ref[i]);
+        vecBad += avx2 && (vec[i] != ref[i]);
+    }
+
+    auto rate = [&](double ms) { return count / (ms / 1000.0) / 1e6; };
+    cout << count << " positions (" << wins << " won), best of " << reps << "\n"
+         << left << setw(22) << "path" << setw(12) << "time(ms)"
+         << setw(14) << "Mpos/s" << setw(10) << "speedup" << "mismatches\n"
+         << fixed << setprecision(2)
+         << setw(22) << "board evaluator" << setw(12) << refMs
+         << setw(14) << rate(refMs) << setw(10) << 1.0 << "-\n"
+         << setw(22) << "batch scalar" << setw(12) << scalarMs
+         << setw(14) << rate(scalarMs) << setw(10) << refMs / scalarMs << scalarBad << "\n";
+    if (avx2)
+        cout << setw(22) << "batch avx2" << setw(12) << vecMs
+             << setw(14) << rate(vecMs) << setw(10) << refMs / vecMs << vecBad << "\n";
+    else
+        cout << "batch avx2: not supported on this cpu\n";
+    return (scalarBad || vecBad) ? 1 : 0;
+}
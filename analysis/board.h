@@ -5,15 +5,37 @@
 #include <limits>
 #include <algorithm>
 #include <fstream>
+#include <cstdint>
 using namespace std;
 
+// board size; smaller variants build with -DC4_ROWS=N -DC4_COLS=M
+#ifndef C4_ROWS
+#define C4_ROWS 6
+#endif
+#ifndef C4_COLS
+#define C4_COLS 7
+#endif
+
 // constants for board dimensions and players
-const int ROWS = 6;                   // number of rows in connect four
-const int COLS = 7;                   // number of columns in connect four
+const int ROWS = C4_ROWS;             // number of rows in connect four
+const int COLS = C4_COLS;             // number of columns in connect four
 const char EMPTY = '.';               // symbol for an empty board cell
 const char MAX_PLAYER = 'X';          // symbol for the maximizing player
 const char MIN_PLAYER = 'O';          // symbol for the minimizing player
 
+// bitboard layout used for position keys: each column takes ROWS+1 bits and
+// bit (col*COL_BITS + h) is the cell h rows up from the bottom of 'col'.
+// the spare bit on top of each column is what makes key() unique.
+const int COL_BITS = ROWS + 1;
+static_assert(COL_BITS * COLS <= 64, "board does not fit a 64-bit key");
+
+// one marker bit at the bottom of every column
+constexpr uint64_t bottomMask() {
+    uint64_t m = 0;
+    for (int c = 0; c < COLS; ++c) m |= uint64_t(1) << (c * COL_BITS);
+    return m;
+}
+
 
 // Move structure representing a column choice
 struct Move {
@@ -26,6 +48,8 @@ struct Move {
 class Board {
 public:
     vector<vector<char>> grid;  // 2d grid for board cells
+    uint64_t maxBits  = 0;      // bitboard of MAX_PLAYER pieces (kept in sync by makeMove/undoMove)
+    uint64_t usedBits = 0;      // bitboard of all pieces
 
     // constructor initializes an empty board
     Board() : grid(ROWS, vector<char>(COLS, EMPTY)) {}
@@ -43,6 +67,9 @@ public:
         for (int i = ROWS - 1; i >= 0; --i) {
             if (grid[i][col] == EMPTY) {
                 grid[i][col] = player;
+                uint64_t bit = uint64_t(1) << (col * COL_BITS + ROWS - 1 - i);
+                usedBits |= bit;
+                if (player == MAX_PLAYER) maxBits |= bit;
                 break;
             }
         }
@@ -55,6 +82,9 @@ public:
         for (int i = 0; i < ROWS; ++i) {
             if (grid[i][col] != EMPTY) {
                 grid[i][col] = EMPTY;
+                uint64_t bit = uint64_t(1) << (col * COL_BITS + ROWS - 1 - i);
+                usedBits &= ~bit;
+                maxBits  &= ~bit;
                 break;
             }
         }
@@ -62,6 +92,14 @@ public:
 
 
 
+    // unique 64-bit key for this position: adding the bottom markers to the
+    // occupancy moves a single bit just above each column's top piece, and
+    // the MAX pieces below it can then be read back unambiguously.
+    uint64_t key() const {
+        return usedBits + bottomMask() + maxBits;
+    }
+
+
     // check if the board is completely filled
     bool isFull() const {
         for (int c = 0; c < COLS; ++c)
@@ -104,7 +142,8 @@ public:
                 fout << cell << ' ';
             fout << '\n';
         }
-        fout << "---------------\n0 1 2 3 4 5 6\n";
+        fout << string(2 * COLS + 1, '-') << '\n';
+        for (int c = 0; c < COLS; ++c) fout << c << (c + 1 < COLS ? " " : "\n");
 		
 		
 		if (this->checkWin(MAX_PLAYER))
@@ -119,4 +158,121 @@ public:
 }; // End of Board class
 
 
+
+// cells of column 'c' that can hold pieces
+constexpr uint64_t columnMask(int c) {
+    return ((uint64_t(1) << ROWS) - 1) << (c * COL_BITS);
+}
+
+// top playable cell of column 'c'
+constexpr uint64_t topCellMask(int c) {
+    return uint64_t(1) << (c * COL_BITS + ROWS - 1);
+}
+
+// true if the pieces in bitboard 'b' contain four in a row. the spare bit
+// on top of each column keeps vertical and diagonal runs from wrapping.
+inline bool hasFour(uint64_t b) {
+    const int shifts[4] = {1, COL_BITS, COL_BITS - 1, COL_BITS + 1};
+    for (int s : shifts) {
+        uint64_t m = b & (b >> s);
+        if (m & (m >> (2 * s))) return true;
+    }
+    return false;
+}
+
+// every empty cell that would complete four for the pieces in 'b' (the
+// cell itself need not be playable yet)
+inline uint64_t winningCells(uint64_t b, uint64_t used) {
+    uint64_t r = (b << 1) & (b << 2) & (b << 3);   // vertical: three below
+    const int shifts[3] = {COL_BITS, COL_BITS - 1, COL_BITS + 1};
+    for (int s : shifts) {
+        uint64_t p = (b << s) & (b << 2 * s);
+        r |= p & (b << 3 * s);
+        r |= p & (b >> s);
+        p = (b >> s) & (b >> 2 * s);
+        r |= p & (b << s);
+        r |= p & (b >> 3 * s);
+    }
+    return r & (bottomMask() * ((uint64_t(1) << ROWS) - 1)) & ~used;
+}
+
+// lightweight bitboard-only position for engines that copy positions a lot
+// (playouts, solvers): no grid, just two piece sets and whose turn it is
+struct BitPosition {
+    uint64_t stones[2] = {0, 0};  // [0] MAX_PLAYER pieces, [1] MIN_PLAYER pieces
+    uint64_t used = 0;            // all pieces
+    int toMove = 0;               // index into stones
+    int moves = 0;                // pieces on the board
+
+    BitPosition() {}
+    BitPosition(const Board &board, char player)
+        : stones{board.maxBits, board.usedBits & ~board.maxBits},
+          used(board.usedBits), toMove(player == MAX_PLAYER ? 0 : 1),
+          moves(__builtin_popcountll(board.usedBits)) {}
+
+    bool canPlay(int c) const { return !(used & topCellMask(c)); }
+    bool isFull() const { return moves == ROWS * COLS; }
+
+    // the cell a piece dropped in column 'c' would land on
+    uint64_t moveBit(int c) const { return (used + bottomMask()) & columnMask(c); }
+
+    // true if the side to move wins by playing column 'c'
+    bool isWinningMove(int c) const { return hasFour(stones[toMove] | moveBit(c)); }
+
+    void play(int c) {
+        uint64_t bit = moveBit(c);
+        stones[toMove] |= bit;
+        used |= bit;
+        toMove ^= 1;
+        ++moves;
+    }
+
+    uint64_t key() const { return used + bottomMask() + stones[0]; }
+};
+
+
+// position from its key (the inverse of BitPosition::key()): in every
+// column the highest set bit marks the height, the bits below are MAX pieces
+inline BitPosition positionFromKey(uint64_t key) {
+    BitPosition pos;
+    for (int c = 0; c < COLS; ++c) {
+        uint64_t col = (key >> (c * COL_BITS)) & ((uint64_t(1) << COL_BITS) - 1);
+        int height = 63 - __builtin_clzll(col);
+        uint64_t cells = (uint64_t(1) << height) - 1;
+        pos.used |= cells << (c * COL_BITS);
+        pos.stones[0] |= (col & cells) << (c * COL_BITS);
+    }
+    pos.stones[1] = pos.used & ~pos.stones[0];
+    pos.moves = __builtin_popcountll(pos.used);
+    pos.toMove = pos.moves & 1;
+    return pos;
+}
+
+// key of the left-right mirror image
+inline uint64_t mirrorKey(uint64_t key) {
+    const uint64_t colMask = (uint64_t(1) << COL_BITS) - 1;
+    uint64_t m = 0;
+    for (int c = 0; c < COLS; ++c)
+        m |= ((key >> (c * COL_BITS)) & colMask) << ((COLS - 1 - c) * COL_BITS);
+    return m;
+}
+
+// one key for a position and its mirror image
+inline uint64_t canonicalKey(uint64_t key) {
+    uint64_t m = mirrorKey(key);
+    return m < key ? m : key;
+}
+
+// a Board holding the pieces of 'pos' (who is to move is pos.toMove)
+inline Board boardFromPosition(const BitPosition &pos) {
+    Board board;
+    for (int c = 0; c < COLS; ++c)
+        for (int r = 0; r < ROWS; ++r) {
+            uint64_t bit = uint64_t(1) << (c * COL_BITS + r);
+            if (!(pos.used & bit)) break;
+            board.makeMove(c, (pos.stones[0] & bit) ? MAX_PLAYER : MIN_PLAYER);
+        }
+    return board;
+}
+
 #endif // BOARD_H
\ No newline at end of file
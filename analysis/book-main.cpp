@@ -0,0 +1,110 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "instrumentation.h"
+#include "board.h"
+#include "hueristics.h"
+#include "engine.h"
+#include "book.h"
+#include "positions.h"
+// globals
+thread_local uint64_t g_nodesGenerated = 0;
+thread_local uint64_t g_nodesExpanded  = 0;
+
+// offline opening-book builder: every distinct, undecided position from the
+// empty board up to --plies moves (X first) is searched to --depth on a pool
+// of threads and written as a sorted book file for bestMove to map.
+
+struct BookTask {
+    Board board;
+    char player;
+};
+
+// all distinct positions at ply 0..plies with the side to move, skipping
+// decided and full boards (nothing to book there)
+vector<BookTask> bookPositions(int plies, int threads) {
+    vector<BookTask> out;
+    enumeratePositions(plies, threads, false, [&](int, const vector<uint64_t> &keys) {
+        for (uint64_t key : keys) {
+            BitPosition pos = positionFromKey(key);
+            out.push_back({boardFromPosition(pos), playerToMove(pos)});
+        }
+    });
+    return out;
+}
+
+int main(int argc, char* argv[]) {
+    int plies = 4, depth = 10, threads = int(thread::hardware_concurrency());
+    EvalKind eval = EVAL_BY_SIDE;
+    size_t ttMB = 16, sharedMB = 0;
+    string outPath = "book.bin";
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool more = i + 1 < argc;
+        if (arg == "--plies" && more)                               plies = atoi(argv[++i]);
+        else if (arg == "--depth" && more)                          depth = atoi(argv[++i]);
+        else if (arg == "--eval" && more && parseEvalKind(argv[i+1], eval)) ++i;
+        else if (arg == "--threads" && more)                        threads = atoi(argv[++i]);
+        else if (arg == "--tt-mb" && more)                          ttMB = atol(argv[++i]);
+        else if (arg == "--shared-tt" && more)                      sharedMB = atol(argv[++i]);
+        else if (arg == "--out" && more)                            outPath = argv[++i];
+        else {
+            cerr << "Usage: " << argv[0] << " [--plies N] [--depth D]"
+                 << " [--eval side|center|sparse|tuned] [--threads N] [--tt-mb N] [--shared-tt MB] [--out FILE]" << endl;
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+
+    vector<BookTask> tasks = bookPositions(plies, threads);
+    vector<BookEntry> entries(tasks.size());
+    cout << tasks.size() << " positions up to ply " << plies << ", depth " << depth
+         << ", eval " << evalName(eval) << ", " << threads << " threads" << endl;
+
+    // neighbouring book positions share most of their subtrees, so with
+    // --shared-tt the workers pool their results in one lock-free table
+    SharedTranspositionTable shared(sharedMB);
+    atomic<size_t> next{0};
+    atomic<uint64_t> nodes{0};
+    auto worker = [&]() {
+        if (shared.enabled()) transpositionTable().attach(&shared);
+        else transpositionTable().resize(ttMB);
+        for (size_t i; (i = next.fetch_add(1)) < tasks.size(); ) {
+            BookTask &t = tasks[i];
+            int score = 0;
+            uint64_t nodes0 = g_nodesGenerated;
+            Move mv = bestMove(t.board, depth, t.player, eval, &score);
+            nodes += g_nodesGenerated - nodes0;
+
+            BookEntry &e = entries[i];
+            e = BookEntry();
+            e.key = searchKey(t.board, t.player, eval);
+            e.score = score;
+            e.move = int8_t(mv.col);
+        }
+    };
+
+    double cpu0 = cpuTimeMs();
+    auto t0 = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool) t.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    if (!writeBook(outPath, entries, plies, depth)) {
+        cerr << "could not write " << outPath << endl;
+        return 1;
+    }
+    cout << "wrote " << entries.size() << " entries to " << outPath << " ("
+         << entries.size() * sizeof(BookEntry) + sizeof(BookHeader) << " bytes), "
+         << nodes.load() << " nodes, " << fixed << setprecision(1)
+         << secs << " s wall, " << (cpuTimeMs() - cpu0) / 1000.0 << " s cpu\n";
+    return 0;
+}
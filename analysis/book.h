@@ -0,0 +1,136 @@
+// book.h
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "board.h"
+
+// opening book: positions up to some ply searched offline (book-main) and
+// stored as a key-sorted array of 16-byte records. bestMove maps the file
+// read-only and binary-searches it before searching, so book moves cost
+// next to nothing. keys are search keys (board key, side to move and
+// evaluator id), so a book only answers for the evaluator it was built with.
+
+const uint32_t BOOK_VERSION = 1;
+
+struct BookHeader {
+    char     magic[4];   // "C4BK"
+    uint32_t version;
+    uint32_t rows, cols;
+    uint32_t plies;      // deepest ply included
+    uint32_t depth;      // search depth used per position
+    uint64_t count;
+};
+
+struct BookEntry {
+    uint64_t key;
+    int32_t  score;
+    int8_t   move;
+    uint8_t  pad[3];
+};
+static_assert(sizeof(BookEntry) == 16, "BookEntry must stay 16 bytes");
+
+// write 'entries' (any order) as a book file
+inline bool writeBook(const string &path, vector<BookEntry> entries, uint32_t plies, uint32_t depth) {
+    sort(entries.begin(), entries.end(),
+         [](const BookEntry &a, const BookEntry &b) { return a.key < b.key; });
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    BookHeader h;
+    memcpy(h.magic, "C4BK", 4);
+    h.version = BOOK_VERSION;
+    h.rows = ROWS; h.cols = COLS;
+    h.plies = plies; h.depth = depth;
+    h.count = entries.size();
+    bool ok = fwrite(&h, sizeof h, 1, f) == 1
+           && fwrite(entries.data(), sizeof(BookEntry), entries.size(), f) == entries.size();
+    return (fclose(f) == 0) && ok;
+}
+
+class OpeningBook {
+public:
+    std::atomic<uint64_t> probes{0}, hits{0};
+
+    ~OpeningBook() { close(); }
+
+    bool open(const string &path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(BookHeader);
+        if (ok) {
+            base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            ok = (base != MAP_FAILED);
+            if (!ok) base = nullptr;
+        }
+        ::close(fd);
+        if (!ok) return false;
+        mapBytes = st.st_size;
+
+        header = static_cast<const BookHeader *>(base);
+        if (memcmp(header->magic, "C4BK", 4) != 0 || header->version != BOOK_VERSION
+            || header->rows != uint32_t(ROWS) || header->cols != uint32_t(COLS)
+            || sizeof(BookHeader) + header->count * sizeof(BookEntry) > mapBytes) {
+            close();
+            return false;
+        }
+        entries = reinterpret_cast<const BookEntry *>(header + 1);
+        count = header->count;
+        openPath = path;
+        return true;
+    }
+
+    const string &filePath() const { return openPath; }   // empty when closed
+    bool enabled() const { return entries != nullptr; }
+    size_t size() const { return count; }
+    int plies() const { return header ? int(header->plies) : 0; }
+    int depth() const { return header ? int(header->depth) : 0; }
+
+    bool probe(uint64_t key, BookEntry &out) {
+        probes.fetch_add(1, std::memory_order_relaxed);
+        const BookEntry *lo = entries, *hi = entries + count;
+        const BookEntry *e = lower_bound(lo, hi, key,
+            [](const BookEntry &a, uint64_t k) { return a.key < k; });
+        if (e == hi || e->key != key) return false;
+        out = *e;
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void close() {
+        openPath.clear();
+        if (base) munmap(base, mapBytes);
+        base = nullptr;
+        mapBytes = 0;
+        header = nullptr;
+        entries = nullptr;
+        count = 0;
+    }
+
+private:
+    string openPath;
+    void *base = nullptr;
+    size_t mapBytes = 0;
+    const BookHeader *header = nullptr;
+    const BookEntry *entries = nullptr;
+    size_t count = 0;
+};
+
+// the book consulted by bestMove, disabled until opened
+inline OpeningBook &openingBook() {
+    static OpeningBook book;
+    return book;
+}
+
+#endif // BOOK_H
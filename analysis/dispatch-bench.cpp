@@ -0,0 +1,168 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include "instrumentation.h"
+#include "board.h"
+#include "hueristics.h"
+// globals
+thread_local uint64_t g_nodesGenerated = 0;
+thread_local uint64_t g_nodesExpanded  = 0;
+
+// benchmark: the templated minMaxAB<MaxToMove, Eval> against the runtime
+// dispatch search it replaced (kept below, frozen, as the reference). both
+// search the same positions to the same depth with the same caches, so
+// scores and node counts must match exactly; only the time may differ.
+
+// reference: side and evaluator chosen by branches at every node
+inline int runtimeEvaluate(const Board &board, bool isMaximizer, EvalKind evalKind) {
+    bool center = (evalKind == EVAL_CENTER) || (evalKind == EVAL_BY_SIDE && isMaximizer);
+    uint64_t id = evalKind;
+    EvalCache &cache = evalCache();
+    uint64_t key = board.key() | evalCacheTag(id, isMaximizer);
+    int score;
+    if (cache.probe(key, score)) return score;
+    score = center ? evaluateWithCenterBias(board) : evaluateWithSparseBias(board);
+    cache.store(key, score);
+    return score;
+}
+
+inline int runtimeMinMaxAB(Board &board, int depth, int alpha, int beta, bool isMaximizer,
+                           EvalKind evalKind) {
+    bool isLeaf = (depth == 0) || board.checkWin(MAX_PLAYER)
+                  || board.checkWin(MIN_PLAYER) || board.isFull();
+    noteNode(isLeaf);
+    if (searchStopped()) return 0;
+
+    if (isLeaf) return runtimeEvaluate(board, isMaximizer, evalKind);
+
+    TranspositionTable &tt = transpositionTable();
+    uint64_t key = searchKey(board, isMaximizer ? MAX_PLAYER : MIN_PLAYER, evalKind);
+    int ttMove = -1;
+    if (tt.enabled()) {
+        TTEntry e;
+        if (tt.probe(key, e)) {
+            if (e.depth >= depth) {
+                if (e.bound == BOUND_EXACT) return e.score;
+                if (e.bound == BOUND_LOWER && e.score >= beta) return e.score;
+                if (e.bound == BOUND_UPPER && e.score <= alpha) return e.score;
+            }
+            ttMove = e.move;
+        }
+    }
+    int alphaOrig = alpha, betaOrig = beta;
+    int bestCol = -1;
+    int result;
+
+    if (isMaximizer) {
+        int maxEval = std::numeric_limits<int>::min();
+        for (int i = 0; i < COLS; ++i) {
+            int c = orderedColumn(i, ttMove);
+            if (!board.isValidMove(c)) continue;
+            board.makeMove(c, MAX_PLAYER);
+            int eval = runtimeMinMaxAB(board, depth-1, alpha, beta, false, evalKind);
+            board.undoMove(c);
+            if (eval > maxEval) { maxEval = eval; bestCol = c; }
+            alpha = std::max(alpha, eval);
+            if (beta <= alpha) break;
+        }
+        result = maxEval;
+    } else {
+        int minEval = std::numeric_limits<int>::max();
+        for (int i = 0; i < COLS; ++i) {
+            int c = orderedColumn(i, ttMove);
+            if (!board.isValidMove(c)) continue;
+            board.makeMove(c, MIN_PLAYER);
+            int eval = runtimeMinMaxAB(board, depth-1, alpha, beta, true, evalKind);
+            board.undoMove(c);
+            if (eval < minEval) { minEval = eval; bestCol = c; }
+            beta = std::min(beta, eval);
+            if (beta <= alpha) break;
+        }
+        result = minEval;
+    }
+    if (searchControl().aborted) return result;
+
+    TTBound bound = (result <= alphaOrig) ? BOUND_UPPER
+                  : (result >= betaOrig)  ? BOUND_LOWER
+                                          : BOUND_EXACT;
+    if (tt.enabled()) tt.store(key, result, depth, bound, bestCol);
+    return result;
+}
+
+// a few reproducible middlegame-ish positions: every 3-ply opening
+vector<Board> benchPositions() {
+    vector<Board> out;
+    for (int a = 0; a < COLS; ++a)
+        for (int b = 0; b < COLS; ++b)
+            for (int c = 0; c < COLS; ++c) {
+                Board board;
+                board.makeMove(a, MAX_PLAYER);
+                board.makeMove(b, MIN_PLAYER);
+                board.makeMove(c, MAX_PLAYER);
+                out.push_back(board);
+            }
+    return out;
+}
+
+struct BenchResult {
+    double ms;
+    uint64_t nodes;
+    long long scoreSum;
+};
+
+template <class SearchFn>
+BenchResult runBench(vector<Board> &positions, int depth, size_t ttMB, SearchFn search) {
+    transpositionTable().resize(ttMB);
+    evalCache().clear();
+    g_nodesGenerated = g_nodesExpanded = 0;
+    long long sum = 0;
+    auto t0 = chrono::steady_clock::now();
+    for (Board &b : positions)
+        sum += search(b, depth);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    return {ms, g_nodesGenerated, sum};
+}
+
+int main(int argc, char* argv[]) {
+    int depth = (argc > 1) ? atoi(argv[1]) : 7;
+    int reps  = (argc > 2) ? atoi(argv[2]) : 3;
+    vector<Board> positions = benchPositions();
+    const EvalKind kinds[] = {EVAL_BY_SIDE, EVAL_CENTER, EVAL_SPARSE};
+    const char *names[] = {"side", "center", "sparse"};
+    bool allMatch = true;
+
+    cout << positions.size() << " positions, MIN to move, depth " << depth
+         << ", best of " << reps << "\n"
+         << left << setw(8) << "eval" << setw(6) << "tt"
+         << setw(14) << "runtime(ms)" << setw(14) << "template(ms)"
+         << setw(10) << "speedup" << setw(14) << "nodes" << "match\n";
+
+    for (int k = 0; k < 3; ++k) {
+        for (size_t ttMB : {size_t(0), size_t(16)}) {
+            BenchResult bestR{1e30, 0, 0}, bestT{1e30, 0, 0};
+            for (int r = 0; r < reps; ++r) {
+                BenchResult rr = runBench(positions, depth, ttMB, [&](Board &b, int d) {
+                    return runtimeMinMaxAB(b, d, std::numeric_limits<int>::min(),
+                                           std::numeric_limits<int>::max(), false, kinds[k]);
+                });
+                BenchResult tr = runBench(positions, depth, ttMB, [&](Board &b, int d) {
+                    return minMaxAB(b, d, std::numeric_limits<int>::min(),
+                                    std::numeric_limits<int>::max(), false, kinds[k]);
+                });
+                if (rr.ms < bestR.ms) bestR = rr;
+                if (tr.ms < bestT.ms) bestT = tr;
+            }
+            bool match = bestR.nodes == bestT.nodes && bestR.scoreSum == bestT.scoreSum;
+            allMatch = allMatch && match;
+            cout << left << setw(8) << names[k] << setw(6) << ttMB
+                 << setw(14) << fixed << setprecision(1) << bestR.ms
+                 << setw(14) << bestT.ms
+                 << setw(10) << setprecision(2) << bestR.ms / bestT.ms
+                 << setw(14) << bestT.nodes << (match ? "yes" : "NO") << "\n";
+        }
+    }
+    return allMatch ? 0 : 1;
+}
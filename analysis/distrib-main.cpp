@@ -0,0 +1,553 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <limits>
+#include <chrono>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "instrumentation.h"
+#include "board.h"
+#include "engine.h"
+#include "positions.h"
+// globals
+thread_local uint64_t g_nodesGenerated = 0;
+thread_local uint64_t g_nodesExpanded  = 0;
+
+// multi-process search: a coordinator splits the work into units and hands
+// them to worker processes (this program re-run with --worker) over local
+// socket pairs, one unit in flight per worker.
+//
+//   distrib-main [--moves "C1 C2 ..."] [--depth D] [--workers N] ...
+//       split bestMove of the position two plies deep: every (move, reply)
+//       pair is a unit searched to depth-2 with a full window, and the
+//       coordinator takes the minimax of the results. the answer is the
+//       same move and score bestMove gives in one process; the price is the
+//       pruning lost across the first two plies.
+//   distrib-main --batch PLIES [--depth D] [--workers N] ...
+//       every distinct undecided position at PLIES moves is one unit
+//       (bestMove at depth D)
+//
+// other options: --eval side|center|sparse|tuned, --tt-mb N (per process),
+// --kill-after K (kill a busy worker once K units are done, to exercise
+// recovery), --unit-timeout MS (a unit running longer is treated as a hung
+// worker), --respawns N (replacement workers allowed per run).
+//
+// a worker that dies or hangs has its unit put back on the queue and is
+// replaced while the respawn budget lasts; a unit that has failed three
+// times, or any unit left once no worker remains, is searched by the
+// coordinator itself, so a run always completes.
+//
+// the run is repeated on 1, 2, 4 ... N workers after a single-process
+// baseline and reported as time, speedup and whether the answers match.
+//
+// worker protocol, one line each way per unit:
+//   unit ID best|value DEPTH EVAL [C1 C2 ...]   (moves from the empty board, X first)
+//   done ID SCORE COL NODES
+
+using Clock = chrono::steady_clock;
+
+struct WorkUnit {
+    vector<int> moves;
+    int depth = 0;
+    bool best = false;       // bestMove (score and column) rather than the position's value
+    int score = 0, col = -1;
+    uint64_t nodes = 0;
+    int attempts = 0;
+    bool done = false;
+};
+
+// minimax value of the position for the side to move, full window
+template <class Eval>
+int valueOf(Board &board, int depth, char player) {
+    const int lo = numeric_limits<int>::min(), hi = numeric_limits<int>::max();
+    return player == MAX_PLAYER ? minMaxAB<true,  Eval>(board, depth, lo, hi)
+                                : minMaxAB<false, Eval>(board, depth, lo, hi);
+}
+
+int positionValue(Board &board, int depth, char player, EvalKind eval) {
+    transpositionTable().newSearch();
+    switch (eval) {
+    case EVAL_CENTER: return valueOf<CenterBiasEval>(board, depth, player);
+    case EVAL_SPARSE: return valueOf<SparseBiasEval>(board, depth, player);
+    case EVAL_TUNED:  return valueOf<TunedEval>(board, depth, player);
+    default:          return valueOf<BySideEval>(board, depth, player);
+    }
+}
+
+char replay(const vector<int> &moves, Board &board) {
+    char player = MAX_PLAYER;
+    for (int c : moves) {
+        board.makeMove(c, player);
+        player = (player == MAX_PLAYER) ? MIN_PLAYER : MAX_PLAYER;
+    }
+    return player;
+}
+
+// what a worker does with a unit (and the coordinator, as a fallback)
+void runUnit(WorkUnit &u, EvalKind eval) {
+    Board board;
+    char player = replay(u.moves, board);
+    uint64_t nodes0 = g_nodesGenerated;
+    if (u.best) u.col = bestMove(board, u.depth, player, eval, &u.score).col;
+    else        u.score = positionValue(board, u.depth, player, eval);
+    u.nodes = g_nodesGenerated - nodes0;
+}
+
+int workerMain(size_t ttMB) {
+    transpositionTable().resize(ttMB);
+    printf("ready\n");
+    fflush(stdout);
+    char buf[4096];
+    while (fgets(buf, sizeof buf, stdin)) {
+        stringstream ss(buf);
+        string cmd, kind, evalName;
+        int64_t id;
+        WorkUnit u;
+        EvalKind eval = EVAL_BY_SIDE;
+        if (!(ss >> cmd) || cmd == "quit") break;
+        if (cmd != "unit" || !(ss >> id >> kind >> u.depth >> evalName)
+            || !parseEvalKind(evalName, eval)) {
+            printf("error bad command\n");
+            fflush(stdout);
+            continue;
+        }
+        u.best = (kind == "best");
+        for (int c; ss >> c; ) u.moves.push_back(c);
+        runUnit(u, eval);
+        printf("done %lld %d %d %llu\n", (long long)id, u.score, u.col, (unsigned long long)u.nodes);
+        fflush(stdout);
+    }
+    return 0;
+}
+
+struct CoordinatorOptions {
+    int workers = 1;
+    size_t ttMB = 16;
+    EvalKind eval = EVAL_BY_SIDE;
+    int killAfter = 0;          // 0 = never
+    double unitTimeoutMs = 0;   // 0 = no limit
+    int respawns = 4;
+};
+
+struct RunStats {
+    double seconds = 0;
+    uint64_t nodes = 0;
+    int failures = 0, requeued = 0, local = 0;
+};
+
+class Coordinator {
+public:
+    explicit Coordinator(const CoordinatorOptions &options) : opt(options) {}
+
+    // every unit done by the workers (or, failing them, here); the clock
+    // starts once all workers have reported ready
+    RunStats run(vector<WorkUnit> &units) {
+        stats = RunStats();
+        respawnsLeft = opt.respawns;
+        procs.assign(opt.workers, WorkerProc());
+        for (auto &p : procs) spawn(p);
+        for (auto &p : procs) awaitReady(p);
+
+        auto t0 = Clock::now();
+        deque<size_t> pending;
+        for (size_t i = 0; i < units.size(); ++i) pending.push_back(i);
+        size_t done = 0;
+        bool killed = false;
+        while (done < units.size()) {
+            // hand out work
+            for (auto &p : procs) {
+                if (p.fd < 0 || p.unit >= 0 || pending.empty()) continue;
+                size_t i = pending.front();
+                pending.pop_front();
+                if (!dispatch(p, i, units[i])) {
+                    fail(p, units, pending);
+                    continue;
+                }
+            }
+            // fault injection: lose a busy worker once, mid-run
+            if (opt.killAfter && !killed && done >= size_t(opt.killAfter)) {
+                for (auto &p : procs)
+                    if (p.fd >= 0 && p.unit >= 0) { kill(p.pid, SIGKILL); break; }
+                killed = true;
+            }
+            if (liveWorkers() == 0) {
+                // nobody left: finish here
+                while (!pending.empty()) {
+                    size_t i = pending.front();
+                    pending.pop_front();
+                    runLocal(units[i]);
+                    ++done;
+                }
+                break;
+            }
+
+            vector<pollfd> fds;
+            vector<WorkerProc *> owners;
+            for (auto &p : procs)
+                if (p.fd >= 0 && p.unit >= 0) {
+                    fds.push_back({p.fd, POLLIN, 0});
+                    owners.push_back(&p);
+                }
+            if (fds.empty()) continue;
+            poll(fds.data(), fds.size(), 50);
+            for (size_t k = 0; k < fds.size(); ++k) {
+                WorkerProc &p = *owners[k];
+                if (fds[k].revents == 0) {
+                    double ms = chrono::duration<double, milli>(Clock::now() - p.sentAt).count();
+                    if (opt.unitTimeoutMs > 0 && ms > opt.unitTimeoutMs) fail(p, units, pending);
+                    continue;
+                }
+                if (!receive(p, units, done)) fail(p, units, pending);
+            }
+            // units that keep failing are not sent out again
+            for (size_t n = pending.size(); n-- > 0; ) {
+                size_t i = pending.front();
+                pending.pop_front();
+                if (units[i].attempts >= 3) { runLocal(units[i]); ++done; }
+                else pending.push_back(i);
+            }
+        }
+        stats.seconds = chrono::duration<double>(Clock::now() - t0).count();
+        for (auto &p : procs) shutdown(p);
+        for (const WorkUnit &u : units) stats.nodes += u.nodes;
+        return stats;
+    }
+
+private:
+    struct WorkerProc {
+        pid_t pid = -1;
+        int fd = -1;
+        long unit = -1;            // unit in flight, -1 when idle
+        Clock::time_point sentAt;
+        string buf;                // partial reply line
+    };
+
+    CoordinatorOptions opt;
+    vector<WorkerProc> procs;
+    RunStats stats;
+    int respawnsLeft = 0;
+
+    int liveWorkers() const {
+        int n = 0;
+        for (const auto &p : procs) n += p.fd >= 0;
+        return n;
+    }
+
+    void spawn(WorkerProc &p) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) return;
+        pid_t pid = fork();
+        if (pid < 0) { close(sv[0]); close(sv[1]); return; }
+        if (pid == 0) {
+            dup2(sv[1], 0);
+            dup2(sv[1], 1);
+            close(sv[0]);
+            close(sv[1]);
+            string tt = to_string(opt.ttMB);
+            execl("/proc/self/exe", "distrib-main", "--worker", "--tt-mb", tt.c_str(), (char *)nullptr);
+            _exit(127);
+        }
+        close(sv[1]);
+        p = WorkerProc();
+        p.pid = pid;
+        p.fd = sv[0];
+    }
+
+    // one line from p, waiting at most timeoutMs; false on eof, error or timeout
+    bool readLine(WorkerProc &p, string &line, int timeoutMs) {
+        for (;;) {
+            size_t nl = p.buf.find('\n');
+            if (nl != string::npos) {
+                line = p.buf.substr(0, nl);
+                p.buf.erase(0, nl + 1);
+                return true;
+            }
+            pollfd f{p.fd, POLLIN, 0};
+            if (poll(&f, 1, timeoutMs) <= 0) return false;
+            char chunk[512];
+            ssize_t n = read(p.fd, chunk, sizeof chunk);
+            if (n <= 0) return false;
+            p.buf.append(chunk, n);
+        }
+    }
+
+    void awaitReady(WorkerProc &p) {
+        string line;
+        if (p.fd >= 0 && !(readLine(p, line, 10000) && line == "ready")) {
+            reap(p);
+            ++stats.failures;
+        }
+    }
+
+    bool dispatch(WorkerProc &p, size_t i, WorkUnit &u) {
+        stringstream ss;
+        ss << "unit " << i << (u.best ? " best " : " value ") << u.depth << " " << evalName(opt.eval);
+        for (int c : u.moves) ss << " " << c;
+        ss << "\n";
+        string line = ss.str();
+        p.unit = long(i);
+        p.sentAt = Clock::now();
+        ++u.attempts;
+        return write(p.fd, line.data(), line.size()) == ssize_t(line.size());
+    }
+
+    // read whatever p has sent; false if it is gone or talking nonsense
+    bool receive(WorkerProc &p, vector<WorkUnit> &units, size_t &done) {
+        char chunk[512];
+        ssize_t n = read(p.fd, chunk, sizeof chunk);
+        if (n <= 0) return false;
+        p.buf.append(chunk, n);
+        size_t nl;
+        while ((nl = p.buf.find('\n')) != string::npos) {
+            stringstream ss(p.buf.substr(0, nl));
+            p.buf.erase(0, nl + 1);
+            string word;
+            long id;
+            WorkUnit r;
+            if (!(ss >> word >> id >> r.score >> r.col >> r.nodes) || word != "done" || id != p.unit)
+                return false;
+            WorkUnit &u = units[id];
+            u.score = r.score;
+            u.col = r.col;
+            u.nodes = r.nodes;
+            u.done = true;
+            p.unit = -1;
+            ++done;
+        }
+        return true;
+    }
+
+    // p died, hung or misbehaved: requeue its unit and replace it if allowed
+    void fail(WorkerProc &p, vector<WorkUnit> &units, deque<size_t> &pending) {
+        ++stats.failures;
+        if (p.unit >= 0 && !units[p.unit].done) {
+            pending.push_front(size_t(p.unit));
+            ++stats.requeued;
+        }
+        reap(p);
+        if (respawnsLeft > 0) {
+            --respawnsLeft;
+            spawn(p);
+            awaitReady(p);
+        }
+    }
+
+    void reap(WorkerProc &p) {
+        if (p.fd >= 0) close(p.fd);
+        if (p.pid > 0) {
+            kill(p.pid, SIGKILL);
+            waitpid(p.pid, nullptr, 0);
+        }
+        p = WorkerProc();
+    }
+
+    void shutdown(WorkerProc &p) {
+        if (p.fd < 0) return;
+        (void)!write(p.fd, "quit\n", 5);
+        close(p.fd);
+        waitpid(p.pid, nullptr, 0);
+        p = WorkerProc();
+    }
+
+    void runLocal(WorkUnit &u) {
+        runUnit(u, opt.eval);
+        u.done = true;
+        ++stats.local;
+    }
+};
+
+// the units of a two-ply split of bestMove at 'root', and per root column
+// the units that decide it
+struct RootSplit {
+    vector<WorkUnit> units;
+    vector<vector<size_t>> unitsOfCol;
+};
+
+RootSplit splitRoot(const vector<int> &rootMoves, int depth) {
+    RootSplit split;
+    split.unitsOfCol.resize(COLS);
+    Board board;
+    char player = replay(rootMoves, board);
+    auto add = [&](int col, vector<int> moves, int d) {
+        WorkUnit u;
+        u.moves = moves;
+        u.depth = d;
+        split.unitsOfCol[col].push_back(split.units.size());
+        split.units.push_back(u);
+    };
+    for (int c = 0; c < COLS; ++c) {
+        if (!board.isValidMove(c)) continue;
+        vector<int> moves = rootMoves;
+        moves.push_back(c);
+        board.makeMove(c, player);
+        // a leaf after one ply is a unit of its own
+        if (depth < 2 || board.checkWin(player) || board.isFull()) {
+            add(c, moves, depth - 1);
+        } else {
+            for (int r = 0; r < COLS; ++r) {
+                if (!board.isValidMove(r)) continue;
+                vector<int> deeper = moves;
+                deeper.push_back(r);
+                add(c, deeper, depth - 2);
+            }
+        }
+        board.undoMove(c);
+    }
+    return split;
+}
+
+// bestMove's answer from the finished units: the opponent's choice per
+// column, then the best column, first one wins ties as in bestMove
+Move combineRoot(const RootSplit &split, char player, size_t rootPly, int *score) {
+    bool isMax = (player == MAX_PLAYER);
+    Move best{-1, -1};
+    int bestVal = isMax ? numeric_limits<int>::min() : numeric_limits<int>::max();
+    for (int c = 0; c < COLS; ++c) {
+        const vector<size_t> &ids = split.unitsOfCol[c];
+        if (ids.empty()) continue;
+        int val;
+        if (split.units[ids[0]].moves.size() == rootPly + 1) {
+            val = split.units[ids[0]].score;
+        } else {
+            val = isMax ? numeric_limits<int>::max() : numeric_limits<int>::min();
+            for (size_t i : ids)
+                val = isMax ? min(val, split.units[i].score) : max(val, split.units[i].score);
+        }
+        if (isMax ? val > bestVal : val < bestVal) {
+            bestVal = val;
+            best.col = c;
+        }
+    }
+    if (score) *score = bestVal;
+    return best;
+}
+
+// every distinct undecided position after 'plies' moves, as bestMove units
+vector<WorkUnit> batchUnits(int plies, int depth) {
+    vector<WorkUnit> out;
+    for (uint64_t key : enumeratePositions(plies)) {
+        WorkUnit u;
+        string moves;
+        moveSequence(boardFromPosition(positionFromKey(key)), moves);
+        for (char ch : moves) u.moves.push_back(ch - '0');
+        u.depth = depth;
+        u.best = true;
+        out.push_back(u);
+    }
+    return out;
+}
+
+int main(int argc, char* argv[]) {
+    CoordinatorOptions opt;
+    opt.workers = max(1, int(thread::hardware_concurrency()));
+    string moves;
+    int depth = 9, batchPlies = -1;
+    bool worker = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool more = i + 1 < argc;
+        if (arg == "--worker")                       worker = true;
+        else if (arg == "--moves" && more)           moves = argv[++i];
+        else if (arg == "--batch" && more)           batchPlies = atoi(argv[++i]);
+        else if (arg == "--depth" && more)           depth = atoi(argv[++i]);
+        else if (arg == "--workers" && more)         opt.workers = atoi(argv[++i]);
+        else if (arg == "--tt-mb" && more)           opt.ttMB = atol(argv[++i]);
+        else if (arg == "--kill-after" && more)      opt.killAfter = atoi(argv[++i]);
+        else if (arg == "--unit-timeout" && more)    opt.unitTimeoutMs = atof(argv[++i]);
+        else if (arg == "--respawns" && more)        opt.respawns = atoi(argv[++i]);
+        else if (arg == "--eval" && more && parseEvalKind(argv[i+1], opt.eval)) ++i;
+        else {
+            cerr << "Usage: " << argv[0] << " [--moves \"C1 C2 ...\" | --batch PLIES] [--depth D]"
+                 << " [--workers N] [--eval side|center|sparse|tuned] [--tt-mb N]\n"
+                 << "       [--kill-after K] [--unit-timeout MS] [--respawns N]" << endl;
+            return 1;
+        }
+    }
+    if (worker) return workerMain(opt.ttMB);
+    signal(SIGPIPE, SIG_IGN);   // a dead worker shows up as a failed write
+    if (opt.workers < 1 || depth < 1) { cerr << "need at least one worker and depth 1" << endl; return 1; }
+
+    vector<int> rootMoves;
+    Board root;
+    {
+        stringstream ss(moves);
+        char player = MAX_PLAYER;
+        for (int c; ss >> c; ) {
+            if (c < 0 || c >= COLS || !root.isValidMove(c)) { cerr << "illegal move " << c << endl; return 1; }
+            root.makeMove(c, player);
+            if (root.checkWin(player) || root.isFull()) { cerr << "the game is over at move " << c << endl; return 1; }
+            player = (player == MAX_PLAYER) ? MIN_PLAYER : MAX_PLAYER;
+            rootMoves.push_back(c);
+        }
+    }
+    char player = (rootMoves.size() % 2) ? MIN_PLAYER : MAX_PLAYER;
+    bool batch = batchPlies >= 0;
+
+    // single-process baseline
+    transpositionTable().resize(opt.ttMB);
+    vector<WorkUnit> baseUnits = batch ? batchUnits(batchPlies, depth) : vector<WorkUnit>();
+    int baseScore = 0;
+    Move baseMove{-1, -1};
+    g_nodesGenerated = 0;
+    auto t0 = Clock::now();
+    if (batch) for (WorkUnit &u : baseUnits) runUnit(u, opt.eval);
+    else       baseMove = bestMove(root, depth, player, opt.eval, &baseScore);
+    double baseSecs = chrono::duration<double>(Clock::now() - t0).count();
+    uint64_t baseNodes = g_nodesGenerated;
+
+    size_t unitCount = batch ? baseUnits.size() : splitRoot(rootMoves, depth).units.size();
+    if (batch)
+        cout << "batch: " << unitCount << " positions at ply " << batchPlies << ", depth " << depth;
+    else
+        cout << "root split of \"" << moves << "\" at depth " << depth << ": " << unitCount
+             << " units; single process plays " << baseMove.col << " (score " << baseScore << ")";
+    cout << ", eval " << evalName(opt.eval) << "\n\n" << left
+         << setw(18) << "run" << setw(11) << "time(s)" << setw(10) << "speedup"
+         << setw(14) << "nodes" << setw(10) << "failures" << setw(10) << "requeued"
+         << setw(8) << "local" << "same answer\n"
+         << setw(18) << "single process" << fixed << setprecision(3) << setw(11) << baseSecs
+         << setw(10) << "1.00" << setw(14) << baseNodes << setw(10) << "-" << setw(10) << "-"
+         << setw(8) << "-" << "-\n";
+
+    vector<int> counts;
+    for (int w = 1; w < opt.workers; w *= 2) counts.push_back(w);
+    counts.push_back(opt.workers);
+    bool allSame = true;
+    for (int w : counts) {
+        CoordinatorOptions o = opt;
+        o.workers = w;
+        Coordinator coordinator(o);
+        bool same = true;
+        RunStats s;
+        if (batch) {
+            vector<WorkUnit> units = batchUnits(batchPlies, depth);
+            s = coordinator.run(units);
+            for (size_t i = 0; i < units.size(); ++i)
+                same = same && units[i].col == baseUnits[i].col && units[i].score == baseUnits[i].score;
+        } else {
+            RootSplit split = splitRoot(rootMoves, depth);
+            s = coordinator.run(split.units);
+            int score;
+            Move mv = combineRoot(split, player, rootMoves.size(), &score);
+            same = mv.col == baseMove.col && score == baseScore;
+        }
+        allSame = allSame && same;
+        string label = to_string(w) + (w == 1 ? " worker" : " workers");
+        cout << setw(18) << label << setprecision(3) << setw(11) << s.seconds
+             << setprecision(2) << setw(10) << (s.seconds > 0 ? baseSecs / s.seconds : 0.0)
+             << setw(14) << s.nodes << setw(10) << s.failures << setw(10) << s.requeued
+             << setw(8) << s.local << (same ? "yes" : "NO") << "\n";
+    }
+    return allSame ? 0 : 1;
+}
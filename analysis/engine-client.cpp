@@ -0,0 +1,142 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "board.h"
+
+// local test client for engine-main: starts one engine process on pipes,
+// plays G self-play games through it at once (every game gets its "go"
+// before any answer is read, so the engine interleaves them) and reports
+// per-move latency and overall throughput.
+
+using Clock = chrono::steady_clock;
+
+struct ClientGame {
+    string id;
+    Board board;
+    char toMove = MAX_PLAYER;
+    string moves;          // " 3 3 4 ..." as sent in position
+    bool over = false;
+    Clock::time_point sentAt;
+};
+
+double percentile(vector<double> v, double p) {
+    if (v.empty()) return 0;
+    sort(v.begin(), v.end());
+    size_t i = size_t(p * (v.size() - 1) + 0.5);
+    return v[i];
+}
+
+int main(int argc, char* argv[]) {
+    string enginePath = "./engine-main";
+    string goOptions = "depth 6";
+    int games = 4, rounds = 1;
+    string threads = "";
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool more = i + 1 < argc;
+        if (arg == "--engine" && more)       enginePath = argv[++i];
+        else if (arg == "--go" && more)      goOptions = argv[++i];
+        else if (arg == "--games" && more)   games = atoi(argv[++i]);
+        else if (arg == "--rounds" && more)  rounds = atoi(argv[++i]);
+        else if (arg == "--threads" && more) threads = argv[++i];
+        else {
+            cerr << "Usage: " << argv[0] << " [--engine PATH] [--go \"depth 6\"]"
+                 << " [--games N] [--rounds N] [--threads N]" << endl;
+            return 1;
+        }
+    }
+
+    // spawn the engine with its stdin/stdout on two pipes
+    int toEngine[2], fromEngine[2];
+    if (pipe(toEngine) < 0 || pipe(fromEngine) < 0) { perror("pipe"); return 1; }
+    auto spawned = Clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(toEngine[0], 0);
+        dup2(fromEngine[1], 1);
+        close(toEngine[1]);
+        close(fromEngine[0]);
+        if (threads.empty()) execl(enginePath.c_str(), enginePath.c_str(), (char *)nullptr);
+        else execl(enginePath.c_str(), enginePath.c_str(), "--threads", threads.c_str(), (char *)nullptr);
+        perror("exec");
+        _exit(127);
+    }
+    close(toEngine[0]);
+    close(fromEngine[1]);
+    FILE *send = fdopen(toEngine[1], "w");
+    FILE *recv = fdopen(fromEngine[0], "r");
+    auto command = [&](const string &line) {
+        fprintf(send, "%s\n", line.c_str());
+        fflush(send);
+    };
+
+    char buf[4096];
+    command("isready");
+    while (fgets(buf, sizeof buf, recv) && string(buf).rfind("readyok", 0) != 0) {}
+    double startupMs = chrono::duration<double, milli>(Clock::now() - spawned).count();
+
+    vector<double> latencies;
+    int finished = 0;
+    auto t0 = Clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        map<string, ClientGame> active;
+        for (int g = 0; g < games; ++g) {
+            ClientGame game;
+            game.id = "g" + to_string(round) + "_" + to_string(g);
+            command("newgame " + game.id);
+            active[game.id] = game;
+        }
+        size_t open = active.size();
+        for (auto &kv : active) {
+            kv.second.sentAt = Clock::now();
+            command("go " + kv.first + " " + goOptions);
+        }
+        while (open > 0 && fgets(buf, sizeof buf, recv)) {
+            stringstream ss(buf);
+            string word, id;
+            int col;
+            ss >> word;
+            if (word == "error") { cerr << "engine: " << buf; return 1; }
+            if (word != "bestmove" || !(ss >> id >> col)) continue;
+            ClientGame &game = active[id];
+            latencies.push_back(chrono::duration<double, milli>(Clock::now() - game.sentAt).count());
+
+            game.board.makeMove(col, game.toMove);
+            game.moves += " " + to_string(col);
+            game.toMove = (game.toMove == MAX_PLAYER) ? MIN_PLAYER : MAX_PLAYER;
+            if (game.board.isFull() || game.board.checkWin(MAX_PLAYER) || game.board.checkWin(MIN_PLAYER)) {
+                --open;
+                ++finished;
+                continue;
+            }
+            command("position " + id + " moves" + game.moves);
+            game.sentAt = Clock::now();
+            command("go " + id + " " + goOptions);
+        }
+    }
+    double wallMs = chrono::duration<double, milli>(Clock::now() - t0).count();
+    command("quit");
+    fclose(send);
+    fclose(recv);
+    waitpid(pid, nullptr, 0);
+
+    cout << fixed << setprecision(2)
+         << "engine startup to readyok: " << startupMs << " ms\n"
+         << finished << " games, " << latencies.size() << " moves in "
+         << wallMs / 1000.0 << " s (" << latencies.size() / (wallMs / 1000.0) << " moves/s)\n"
+         << "move latency ms: p50 " << percentile(latencies, 0.50)
+         << "  p95 " << percentile(latencies, 0.95)
+         << "  p99 " << percentile(latencies, 0.99)
+         << "  max " << percentile(latencies, 1.0) << "\n";
+    return 0;
+}
@@ -0,0 +1,404 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <memory>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "instrumentation.h"
+#include "board.h"
+#include "engine.h"
+#include "multipv.h"
+// globals
+thread_local uint64_t g_nodesGenerated = 0;
+thread_local uint64_t g_nodesExpanded  = 0;
+
+// long-running engine process. reads one command per line on stdin (or on
+// each connection to --socket PATH) and answers on the same stream, so a
+// front-end keeps one warm process (caches and search threads included)
+// for any number of sequential or interleaved games.
+//
+//   newgame ID                      start or reset game ID
+//   position ID [moves C1 C2 ...]   set game ID to the moves from the empty
+//                                   board, X first; no moves after a win
+//   endgame ID                      forget game ID (stopping its search);
+//                                   ids are kept until then
+//   go ID [depth N] [time MS] [nodes N] [eval side|center|sparse|tuned]
+//         [engine ab|mcts] [playouts N] [threats N] [multipv K]
+//                                   search the side to move of game ID;
+//                                   multipv K > 1 scores the K best moves
+//                                   exactly (alpha-beta only: with
+//                                   engine mcts it is an error)
+//   stop [ID]                       stop one search (or all) early
+//   isready                         answered with readyok
+//   quit                            exit (disconnect on a socket)
+//
+// replies:
+//   info ID depth D nodes N time MS col C   after each finished iteration
+//   info ID depth D multipv I score S pv C1 C2 ...
+//                                   with multipv, line I (1 = best) of that
+//                                   iteration; scores favour X when higher
+//   bestmove ID C
+//   error TEXT
+//
+// with --slow-log FILE, searches over --slow-ms or --slow-nodes are captured
+// there (watchdog.h) for replay-main.
+
+struct GameState {
+    Board board;
+    char toMove = MAX_PLAYER;
+    bool searching = false;
+    atomic<bool> stop{false};
+};
+
+struct SearchJob {
+    string id;
+    shared_ptr<GameState> game;
+    Board board;
+    char player;
+    EngineSettings settings;
+    uint64_t nodeLimit;
+    int multiPV;
+};
+
+class EngineServer {
+public:
+    // sharedMB > 0 gives all workers one lock-free table instead of ttMB each
+    EngineServer(int threads, size_t ttMB, size_t sharedMB = 0) {
+        if (sharedMB) sharedTT.resize(sharedMB);
+        for (int i = 0; i < threads; ++i)
+            pool.emplace_back([this, ttMB] { worker(ttMB); });
+    }
+
+    ~EngineServer() {
+        {
+            lock_guard<mutex> lock(jobMtx);
+            shuttingDown = true;
+        }
+        jobCv.notify_all();
+        for (auto &t : pool) t.join();
+    }
+
+    // serve commands from 'in' until quit or end of input; returns true on quit
+    bool serve(FILE *in, FILE *reply) {
+        {
+            lock_guard<mutex> lock(outMtx);
+            out = reply;
+            clientGone = false;
+        }
+        // end of input lets running searches finish; quit stops them
+        char buf[4096];
+        bool quit = false;
+        while (!quit && fgets(buf, sizeof buf, in))
+            quit = handle(buf);
+        if (quit) stopAll();
+        waitIdle();
+        return quit;
+    }
+
+private:
+    SharedTranspositionTable sharedTT;
+    vector<thread> pool;
+    deque<SearchJob> jobs;
+    mutex jobMtx;
+    condition_variable jobCv, idleCv;
+    int running = 0;
+    bool shuttingDown = false;
+
+    map<string, shared_ptr<GameState>> games;
+    mutex gamesMtx;
+
+    FILE *out = stdout;
+    mutex outMtx;
+    // set when a reply cannot be written (EPIPE: the client hung up); its
+    // searches are stopped and further replies dropped
+    atomic<bool> clientGone{false};
+
+    void send(const string &line) {
+        lock_guard<mutex> lock(outMtx);
+        if (clientGone) return;
+        fputs(line.c_str(), out);
+        fputc('\n', out);
+        if (fflush(out) != 0 || ferror(out)) {
+            if (errno == EPIPE) cerr << "client disconnected" << endl;
+            clientGone = true;
+        }
+    }
+
+    shared_ptr<GameState> game(const string &id, bool create) {
+        lock_guard<mutex> lock(gamesMtx);
+        auto it = games.find(id);
+        if (it != games.end()) return it->second;
+        if (!create) return nullptr;
+        return games[id] = make_shared<GameState>();
+    }
+
+    bool handle(const string &line) {
+        stringstream ss(line);
+        string cmd, id;
+        ss >> cmd;
+        if (cmd.empty()) return false;
+        if (cmd == "quit") return true;
+        if (cmd == "isready") { send("readyok"); return false; }
+        if (cmd == "stop") {
+            if (ss >> id) { if (auto g = game(id, false)) g->stop = true; }
+            else stopAll();
+            return false;
+        }
+        if (!(ss >> id)) { send("error missing game id: " + cmd); return false; }
+
+        if (cmd == "endgame") {
+            // a running search keeps its own reference and still answers
+            lock_guard<mutex> lock(gamesMtx);
+            auto it = games.find(id);
+            if (it == games.end()) { send("error unknown game " + id); return false; }
+            it->second->stop = true;
+            games.erase(it);
+            return false;
+        }
+
+        if (cmd == "newgame" || cmd == "position") {
+            shared_ptr<GameState> g = game(id, true);
+            lock_guard<mutex> lock(gamesMtx);
+            if (g->searching) { send("error " + id + " is searching"); return false; }
+            Board board;
+            char player = MAX_PLAYER;
+            string word;
+            if (cmd == "position" && ss >> word) {
+                if (word != "moves") { send("error " + id + " expected moves, got " + word); return false; }
+                bool over = false;
+                while (ss >> word) {
+                    char *end;
+                    long c = strtol(word.c_str(), &end, 10);
+                    if (*end || c < 0 || c >= COLS || !board.isValidMove(int(c))) {
+                        send("error " + id + " illegal move " + word);
+                        return false;
+                    }
+                    if (over) { send("error " + id + " move " + word + " after the game is over"); return false; }
+                    board.makeMove(int(c), player);
+                    over = board.checkWin(player) || board.isFull();
+                    player = (player == MAX_PLAYER) ? MIN_PLAYER : MAX_PLAYER;
+                }
+            }
+            g->board = board;
+            g->toMove = player;
+        } else if (cmd == "go") {
+            SearchJob job;
+            job.id = id;
+            job.game = game(id, true);
+            job.settings.depth = 0;
+            job.nodeLimit = 0;
+            job.multiPV = 1;
+            string key;
+            while (ss >> key) {
+                string val;
+                if (!(ss >> val)) { send("error " + id + " missing value for " + key); return false; }
+                if (key == "depth")         job.settings.depth = atoi(val.c_str());
+                else if (key == "time")     job.settings.timeMs = job.settings.mcts.timeMs = atof(val.c_str());
+                else if (key == "nodes")    job.nodeLimit = atoll(val.c_str());
+                else if (key == "playouts") job.settings.mcts.playouts = atoll(val.c_str());
+                else if (key == "threats")  job.settings.threats = atoll(val.c_str());
+                else if (key == "multipv")  job.multiPV = atoi(val.c_str());
+                else if (key == "eval" && parseEvalKind(val, job.settings.eval)) {}
+                else if (key == "engine" && parseEngineKind(val, job.settings.kind)) {}
+                else { send("error " + id + " bad go option " + key); return false; }
+            }
+            if (job.multiPV > 1 && job.settings.kind == ENGINE_MCTS) {
+                send("error " + id + " multipv needs the alpha-beta engine");
+                return false;
+            }
+            // time or node limits alone search as deep as they allow
+            if (job.settings.depth <= 0)
+                job.settings.depth = (job.settings.timeMs > 0 || job.nodeLimit) ? ROWS * COLS : 6;
+
+            lock_guard<mutex> lock(gamesMtx);
+            GameState &g = *job.game;
+            if (g.searching) { send("error " + id + " is already searching"); return false; }
+            if (g.board.isFull() || g.board.checkWin(MAX_PLAYER) || g.board.checkWin(MIN_PLAYER)) {
+                send("error " + id + " game is over");
+                return false;
+            }
+            g.searching = true;
+            g.stop = false;
+            job.board = g.board;
+            job.player = g.toMove;
+            {
+                lock_guard<mutex> jl(jobMtx);
+                jobs.push_back(job);
+            }
+            jobCv.notify_one();
+        } else {
+            send("error unknown command " + cmd);
+        }
+        return false;
+    }
+
+    void stopAll() {
+        lock_guard<mutex> lock(gamesMtx);
+        for (auto &kv : games) kv.second->stop = true;
+    }
+
+    // also stops the searches of a client that went away meanwhile
+    void waitIdle() {
+        unique_lock<mutex> lock(jobMtx);
+        while (!idleCv.wait_for(lock, chrono::milliseconds(50),
+                                [this] { return jobs.empty() && running == 0; })) {
+            if (!clientGone) continue;
+            lock.unlock();
+            stopAll();
+            lock.lock();
+        }
+    }
+
+    void worker(size_t ttMB) {
+        if (sharedTT.enabled()) transpositionTable().attach(&sharedTT);
+        else transpositionTable().resize(ttMB);
+        for (;;) {
+            SearchJob job;
+            {
+                unique_lock<mutex> lock(jobMtx);
+                jobCv.wait(lock, [this] { return shuttingDown || !jobs.empty(); });
+                if (jobs.empty()) return;
+                job = jobs.front();
+                jobs.pop_front();
+                ++running;
+            }
+            SearchSnapshot snap = SearchSnapshot::take();
+            auto t0 = chrono::steady_clock::now();
+            int reached = 0, score = 0;
+            Move mv = search(job, reached, score);
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+            slowSearchLog().check(job.board, job.player, engineSpecString(job.settings), true,
+                                  job.nodeLimit, job.multiPV, job.game->stop.load(), snap, ms,
+                                  reached, mv, score);
+            {
+                lock_guard<mutex> lock(gamesMtx);
+                job.game->searching = false;
+            }
+            send("bestmove " + job.id + " " + to_string(mv.col));
+            {
+                lock_guard<mutex> lock(jobMtx);
+                --running;
+            }
+            idleCv.notify_all();
+        }
+    }
+
+    // the move, with the depth finished and its score (both 0 for mcts)
+    Move search(SearchJob &job, int &reached, int &score) {
+        if (job.settings.kind == ENGINE_MCTS) {
+            MctsLimits mcts = job.settings.mcts;
+            mcts.stop = &job.game->stop;
+            return mctsBestMove(job.board, job.player, mcts);
+        }
+
+        auto t0 = chrono::steady_clock::now();
+        uint64_t nodes0 = g_nodesGenerated;
+        SearchLimits limits;
+        limits.depth = job.settings.depth;
+        limits.timeMs = job.settings.timeMs;
+        limits.nodes = job.nodeLimit;
+        limits.stop = &job.game->stop;
+        threatSearch().nodes = job.settings.threats;
+        limits.onIteration = [&](int depth, const Move &mv) {
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+            stringstream info;
+            info << "info " << job.id << " depth " << depth
+                 << " nodes " << (g_nodesGenerated - nodes0)
+                 << " time " << int64_t(ms) << " col " << mv.col;
+            send(info.str());
+        };
+        if (job.multiPV <= 1)
+            return bestMoveWithin(job.board, job.player, limits, job.settings.eval, &reached, &score);
+
+        auto onDepth = [&](int depth, const vector<RootLine> &lines) {
+            for (size_t i = 0; i < lines.size(); ++i) {
+                stringstream info;
+                info << "info " << job.id << " depth " << depth << " multipv " << i + 1
+                     << " score " << lines[i].score << " pv";
+                for (int c : lines[i].pv) info << " " << c;
+                send(info.str());
+            }
+        };
+        vector<RootLine> lines = multiPV(job.board, job.player, limits, job.multiPV,
+                                         job.settings.eval, &reached, onDepth);
+        if (lines.empty()) return Move{-1, -1};
+        score = lines[0].score;
+        return Move{-1, lines[0].col};
+    }
+};
+
+int main(int argc, char* argv[]) {
+    int threads = int(thread::hardware_concurrency());
+    size_t ttMB = 16, sharedMB = 0;
+    string socketPath, bookFile, slowLog;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc)     threads = atoi(argv[++i]);
+        else if (arg == "--tt-mb" && i + 1 < argc)  ttMB = atol(argv[++i]);
+        else if (arg == "--shared-tt" && i + 1 < argc) sharedMB = atol(argv[++i]);
+        else if (arg == "--socket" && i + 1 < argc) socketPath = argv[++i];
+        else if (arg == "--book" && i + 1 < argc)   bookFile = argv[++i];
+        else if (arg == "--slow-log" && i + 1 < argc)   slowLog = argv[++i];
+        else if (arg == "--slow-ms" && i + 1 < argc)    slowSearchLog().thresholdMs = atof(argv[++i]);
+        else if (arg == "--slow-nodes" && i + 1 < argc) slowSearchLog().thresholdNodes = atoll(argv[++i]);
+        else {
+            cerr << "Usage: " << argv[0] << " [--threads N] [--tt-mb N] [--shared-tt MB]"
+                 << " [--socket PATH] [--book FILE]"
+                 << " [--slow-log FILE [--slow-ms MS] [--slow-nodes N]]" << endl;
+            return 1;
+        }
+    }
+    if (!bookFile.empty() && !openingBook().open(bookFile))
+        cerr << "ignoring unreadable opening book " << bookFile << endl;
+    if (!slowLog.empty() && !slowSearchLog().open(slowLog))
+        cerr << "cannot append to slow-search log " << slowLog << endl;
+    if (threads < 1) threads = 1;
+    signal(SIGPIPE, SIG_IGN);   // a client that hangs up shows up as a failed write
+    EngineServer server(threads, ttMB, sharedMB);
+
+    if (socketPath.empty()) {
+        server.serve(stdin, stdout);
+        return 0;
+    }
+
+    // socket mode: one client connection at a time, same protocol
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (listenFd < 0 || socketPath.size() >= sizeof addr.sun_path) {
+        cerr << "cannot create socket " << socketPath << endl;
+        return 1;
+    }
+    socketPath.copy(addr.sun_path, socketPath.size());
+    unlink(socketPath.c_str());
+    if (bind(listenFd, (sockaddr *)&addr, sizeof addr) < 0 || listen(listenFd, 4) < 0) {
+        cerr << "cannot listen on " << socketPath << endl;
+        return 1;
+    }
+    for (;;) {
+        int conn = accept(listenFd, nullptr, nullptr);
+        if (conn < 0) continue;
+        FILE *in = fdopen(conn, "r");
+        FILE *reply = fdopen(dup(conn), "w");
+        bool quit = server.serve(in, reply);
+        fclose(in);
+        fclose(reply);
+        if (quit) break;
+    }
+    close(listenFd);
+    unlink(socketPath.c_str());
+    return 0;
+}
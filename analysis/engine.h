@@ -0,0 +1,125 @@
+// engine.h
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <string>
+#include <sstream>
+#include <cstdlib>
+#include <chrono>
+#include "hueristics.h"
+#include "mcts.h"
+#include "watchdog.h"
+
+// runtime engine selection for the drivers: depth-limited alpha-beta
+// (bestMove, or bestMoveWithin when there is a time budget) or monte carlo
+// tree search (mctsBestMove)
+
+enum EngineKind { ENGINE_MINMAX, ENGINE_MCTS };
+
+struct EngineSettings {
+    EngineKind kind = ENGINE_MINMAX;
+    int depth = 4;                 // minMaxAB cutoff depth (deepest iteration with timeMs)
+    EvalKind eval = EVAL_BY_SIDE;  // leaf evaluator for ENGINE_MINMAX
+    double timeMs = 0;             // per-move budget for ENGINE_MINMAX, 0 = fixed depth
+    uint64_t threats = 0;          // threat-search budget per depth-0 leaf, 0 = off
+    MctsLimits mcts;               // budgets for ENGINE_MCTS
+};
+
+inline const char *engineName(EngineKind kind) {
+    return kind == ENGINE_MCTS ? "mcts" : "minmax";
+}
+
+inline const char *evalName(EvalKind kind) {
+    return kind == EVAL_CENTER ? "center" : kind == EVAL_SPARSE ? "sparse"
+         : kind == EVAL_TUNED ? "tuned" : "side";
+}
+
+// "minmax"/"ab" or "mcts"; returns false for anything else
+inline bool parseEngineKind(const string &name, EngineKind &kind) {
+    if (name == "minmax" || name == "ab") { kind = ENGINE_MINMAX; return true; }
+    if (name == "mcts")                   { kind = ENGINE_MCTS;   return true; }
+    return false;
+}
+
+// "side", "center", "sparse" or "tuned"; "tuned" only on the board size
+// its weights were fitted on
+inline bool parseEvalKind(const string &name, EvalKind &kind) {
+    if (name == "side")   { kind = EVAL_BY_SIDE; return true; }
+    if (name == "center") { kind = EVAL_CENTER;  return true; }
+    if (name == "sparse") { kind = EVAL_SPARSE;  return true; }
+    if (name == "tuned" && TUNED_FITS_BOARD) { kind = EVAL_TUNED; return true; }
+    return false;
+}
+
+// comma-separated key=value list, e.g. "depth=6,eval=center,ms=50" or
+// "engine=mcts,playouts=5000". keys: engine, depth, eval, ms, playouts,
+// threads, threats. unset keys keep their current value.
+inline bool parseEngineSpec(const string &spec, EngineSettings &s) {
+    stringstream ss(spec);
+    string item;
+    while (getline(ss, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == string::npos) return false;
+        string key = item.substr(0, eq), val = item.substr(eq + 1);
+        if (key == "engine")        { if (!parseEngineKind(val, s.kind)) return false; }
+        else if (key == "eval")     { if (!parseEvalKind(val, s.eval)) return false; }
+        else if (key == "depth")    s.depth = atoi(val.c_str());
+        else if (key == "ms")       s.timeMs = s.mcts.timeMs = atof(val.c_str());
+        else if (key == "playouts") s.mcts.playouts = atoll(val.c_str());
+        else if (key == "threads")  s.mcts.threads = atoi(val.c_str());
+        else if (key == "threats")  s.threats = atoll(val.c_str());
+        else return false;
+    }
+    return true;
+}
+
+inline string engineSpecString(const EngineSettings &s) {
+    stringstream ss;
+    ss << "engine=" << engineName(s.kind);
+    if (s.kind == ENGINE_MCTS)
+        ss << ",playouts=" << s.mcts.playouts << ",ms=" << s.mcts.timeMs
+           << ",threads=" << s.mcts.threads;
+    else
+        ss << ",depth=" << s.depth << ",eval=" << evalName(s.eval) << ",ms=" << s.timeMs
+           << ",threats=" << s.threats;
+    return ss.str();
+}
+
+// one move for 'player', without the slow-search watchdog
+inline Move searchEngineMove(Board &board, char player, const EngineSettings &settings,
+                             int *score = nullptr, int *depthReached = nullptr) {
+    if (settings.kind == ENGINE_MCTS)
+        return mctsBestMove(board, player, settings.mcts);
+    threatSearch().nodes = settings.threats;
+    if (settings.timeMs > 0) {
+        SearchLimits limits;
+        limits.depth = settings.depth;
+        limits.timeMs = settings.timeMs;
+        return bestMoveWithin(board, player, limits, settings.eval, depthReached, score);
+    }
+    if (depthReached) *depthReached = settings.depth;
+    return bestMove(board, settings.depth, player, settings.eval, score);
+}
+
+// one move for 'player'; minimax also reports its score and the depth it
+// finished when asked (mcts leaves both untouched). a search crossing the
+// slowSearchLog() thresholds is captured there.
+inline Move engineMove(Board &board, char player, const EngineSettings &settings,
+                       int *score = nullptr, int *depthReached = nullptr) {
+    SlowSearchLog &log = slowSearchLog();
+    if (!log.enabled()) return searchEngineMove(board, player, settings, score, depthReached);
+
+    Board before = board;
+    int s = score ? *score : 0, reached = depthReached ? *depthReached : 0;
+    SearchSnapshot snap = SearchSnapshot::take();
+    auto t0 = chrono::steady_clock::now();
+    Move mv = searchEngineMove(board, player, settings, &s, &reached);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    log.check(before, player, engineSpecString(settings), settings.timeMs > 0, 0, 1, false, snap, ms,
+              settings.kind == ENGINE_MCTS ? 0 : reached, mv, s);
+    if (score) *score = s;
+    if (depthReached) *depthReached = reached;
+    return mv;
+}
+
+#endif // ENGINE_H
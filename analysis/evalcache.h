@@ -0,0 +1,95 @@
+// evalcache.h
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "board.h"
+
+// evaluation cache: maps a position key to its static score so leaves that
+// are reached again through a different move order skip the two checkWin
+// scans and the 42-cell sweep. it only ever holds static scores, never
+// search results.
+
+// tag bits above the 49-bit board key so each evaluator (and, for
+// side-dependent evaluators, each side to move) gets its own entries
+inline uint64_t evalCacheTag(uint64_t evaluatorId, bool maxToMove) {
+    return ((evaluatorId << 1) | (maxToMove ? 1 : 0)) << 56;
+}
+
+// one cached score, 16 bytes. a real key always has its bottom marker bits
+// set, so a zeroed entry reads as empty.
+struct EvalEntry {
+    uint64_t key;
+    int32_t  score;
+    int32_t  pad;
+};
+
+// four entries fill exactly one cache line
+const int EVAL_BUCKET_SLOTS = 4;
+struct alignas(64) EvalBucket {
+    EvalEntry slot[EVAL_BUCKET_SLOTS];
+};
+
+class EvalCache {
+public:
+    uint64_t probes = 0;  // lookups since the last resetStats()
+    uint64_t hits   = 0;  // lookups that found their key
+
+    explicit EvalCache(size_t sizeKB = 1024) { resize(sizeKB); }
+
+    // resize to the largest power-of-two bucket count that fits in sizeKB
+    void resize(size_t sizeKB) {
+        size_t n = 1;
+        while (n * 2 * sizeof(EvalBucket) <= sizeKB * 1024) n *= 2;
+        buckets.assign(n, EvalBucket{});
+        mask = n - 1;
+        resetStats();
+    }
+
+    void clear() { buckets.assign(buckets.size(), EvalBucket{}); }
+    void resetStats() { probes = hits = 0; }
+
+    size_t sizeBytes() const { return buckets.size() * sizeof(EvalBucket); }
+    double hitRate() const { return probes ? double(hits) / probes : 0.0; }
+
+    bool probe(uint64_t key, int &score) {
+        ++probes;
+        const EvalBucket &b = bucketFor(key);
+        for (int i = 0; i < EVAL_BUCKET_SLOTS; ++i) {
+            if (b.slot[i].key == key) {
+                score = b.slot[i].score;
+                ++hits;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // newest entry goes to the front of its bucket, the oldest falls off
+    void store(uint64_t key, int score) {
+        EvalBucket &b = bucketFor(key);
+        for (int i = EVAL_BUCKET_SLOTS - 1; i > 0; --i)
+            b.slot[i] = b.slot[i - 1];
+        b.slot[0] = {key, score, 0};
+    }
+
+private:
+    vector<EvalBucket> buckets;
+    size_t mask = 0;
+
+    EvalBucket &bucketFor(uint64_t key) {
+        // keys are sparse in their low bits, so mix before indexing
+        uint64_t h = key * 0x9E3779B97F4A7C15ULL;
+        return buckets[(h >> 32) & mask];
+    }
+};
+
+// the cache used by minMaxAB leaves, one per thread
+inline EvalCache &evalCache() {
+    static thread_local EvalCache cache;
+    return cache;
+}
+
+#endif // EVALCACHE_H
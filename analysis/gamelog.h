@@ -0,0 +1,305 @@
+// gamelog.h
+#ifndef GAMELOG_H
+#define GAMELOG_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "board.h"
+
+// game logs as written by analysis-output-main (board dumps plus
+// "Max Computer move: N" / "Min Computer move: N" lines) turned into a
+// columnar dataset: one row per move (game, ply, column, side, key of the
+// position after the move), one row per game (first move row, plies,
+// result, source log) and a key-sorted index over the move rows, so
+// "every game that reached this position" is a binary search.
+//
+// logs are mapped and scanned line by line; only the move lines matter,
+// the dumps are redrawn from them. moves are replayed as they are read, so
+// a game ends where the replay is won or full, and several games may
+// follow each other in one log. a log that stops mid-game keeps its moves
+// with result GAME_UNFINISHED.
+
+const uint32_t DATASET_VERSION = 1;
+const char GAME_DRAW = 'D';
+const char GAME_UNFINISHED = '-';
+
+// read-only mapping of a whole file
+class MappedFile {
+public:
+    const char *data = nullptr;
+    size_t size = 0;
+
+    ~MappedFile() { close(); }
+
+    bool open(const string &path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0;
+        if (ok && st.st_size > 0) {
+            void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            ok = (p != MAP_FAILED);
+            if (ok) {
+                madvise(p, st.st_size, MADV_SEQUENTIAL);
+                data = static_cast<const char *>(p);
+                size = st.st_size;
+            }
+        }
+        ::close(fd);
+        return ok;
+    }
+
+    void close() {
+        if (data) munmap(const_cast<char *>(data), size);
+        data = nullptr;
+        size = 0;
+    }
+};
+
+struct LoggedGame {
+    vector<int8_t>   cols;
+    vector<char>     sides;   // MAX_PLAYER / MIN_PLAYER
+    vector<uint64_t> keys;    // position key after each move
+    char result = GAME_UNFINISHED;
+};
+
+// scan a log for games; onGame(const LoggedGame &) is called for each one.
+// returns the number of move lines that could not be replayed (skipped).
+template <class Fn>
+size_t parseGameLog(const char *text, size_t len, Fn onGame) {
+    static const char maxTag[] = "Max Computer move:";
+    static const char minTag[] = "Min Computer move:";
+    const size_t tagLen = sizeof maxTag - 1;
+    LoggedGame game;
+    BitPosition pos;
+    size_t bad = 0;
+
+    const char *p = text, *end = text + len;
+    while (p < end) {
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+        size_t n = eol - p;
+        char side = 0;
+        if (n > tagLen && memcmp(p, maxTag, tagLen) == 0) side = MAX_PLAYER;
+        else if (n > tagLen && memcmp(p, minTag, tagLen) == 0) side = MIN_PLAYER;
+        if (side) {
+            const char *q = p + tagLen;
+            while (q < eol && *q == ' ') ++q;
+            int col = -1;
+            if (q < eol && *q >= '0' && *q <= '9') {
+                col = 0;
+                while (q < eol && *q >= '0' && *q <= '9') col = col * 10 + (*q++ - '0');
+            }
+            int who = (side == MAX_PLAYER) ? 0 : 1;
+            if (col < 0 || col >= COLS || !pos.canPlay(col) || who != pos.toMove) {
+                ++bad;
+            } else {
+                bool wins = pos.isWinningMove(col);
+                pos.play(col);
+                game.cols.push_back(int8_t(col));
+                game.sides.push_back(side);
+                game.keys.push_back(pos.key());
+                if (wins || pos.isFull()) {
+                    game.result = wins ? side : GAME_DRAW;
+                    onGame(game);
+                    game = LoggedGame();
+                    pos = BitPosition();
+                }
+            }
+        }
+        p = eol + 1;
+    }
+    if (!game.cols.empty()) onGame(game);
+    return bad;
+}
+
+struct DatasetHeader {
+    char     magic[4];   // "C4GD"
+    uint32_t version;
+    uint32_t rows, cols;
+    uint64_t games, moves, sources;
+    uint64_t nameBytes;
+};
+
+// the dataset as plain columns, for building and rewriting
+struct GameDataset {
+    // per move
+    vector<uint64_t> moveKey;
+    vector<uint32_t> moveGame;
+    vector<uint16_t> movePly;
+    vector<int8_t>   moveCol;
+    vector<uint8_t>  moveSide;
+    // per game
+    vector<uint32_t> gameFirst, gameSource;
+    vector<uint16_t> gamePlies;
+    vector<uint8_t>  gameResult;
+    // per source log
+    vector<string>   sourceName;
+    vector<uint64_t> sourceBytes;
+
+    size_t games() const { return gameFirst.size(); }
+    size_t moves() const { return moveKey.size(); }
+
+    bool hasSource(const string &name, uint64_t bytes) const {
+        for (size_t i = 0; i < sourceName.size(); ++i)
+            if (sourceName[i] == name && sourceBytes[i] == bytes) return true;
+        return false;
+    }
+
+    uint32_t addSource(const string &name, uint64_t bytes) {
+        sourceName.push_back(name);
+        sourceBytes.push_back(bytes);
+        return uint32_t(sourceName.size() - 1);
+    }
+
+    void addGame(const LoggedGame &g, uint32_t source) {
+        uint32_t id = uint32_t(games());
+        gameFirst.push_back(uint32_t(moves()));
+        gameSource.push_back(source);
+        gamePlies.push_back(uint16_t(g.cols.size()));
+        gameResult.push_back(uint8_t(g.result));
+        for (size_t i = 0; i < g.cols.size(); ++i) {
+            moveKey.push_back(g.keys[i]);
+            moveGame.push_back(id);
+            movePly.push_back(uint16_t(i));
+            moveCol.push_back(g.cols[i]);
+            moveSide.push_back(uint8_t(g.sides[i]));
+        }
+    }
+
+    // columns back to back, widest first so each stays naturally aligned
+    bool write(const string &path) const {
+        vector<uint32_t> order(moves());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = uint32_t(i);
+        stable_sort(order.begin(), order.end(),
+                    [&](uint32_t a, uint32_t b) { return moveKey[a] < moveKey[b]; });
+        vector<uint64_t> indexKey(order.size());
+        for (size_t i = 0; i < order.size(); ++i) indexKey[i] = moveKey[order[i]];
+        vector<uint32_t> nameOffset;
+        string names;
+        for (const string &s : sourceName) {
+            nameOffset.push_back(uint32_t(names.size()));
+            names += s;
+            names += '\0';
+        }
+
+        string tmp = path + ".tmp";
+        FILE *f = fopen(tmp.c_str(), "wb");
+        if (!f) return false;
+        DatasetHeader h;
+        memcpy(h.magic, "C4GD", 4);
+        h.version = DATASET_VERSION;
+        h.rows = ROWS; h.cols = COLS;
+        h.games = games(); h.moves = moves(); h.sources = sourceName.size();
+        h.nameBytes = names.size();
+        bool ok = fwrite(&h, sizeof h, 1, f) == 1;
+        auto put = [&](const auto &v) {
+            if (!v.empty()) ok = ok && fwrite(v.data(), sizeof v[0], v.size(), f) == v.size();
+        };
+        put(moveKey); put(indexKey); put(sourceBytes);
+        put(moveGame); put(order); put(gameFirst); put(gameSource); put(nameOffset);
+        put(movePly); put(gamePlies);
+        put(moveCol); put(moveSide); put(gameResult);
+        ok = ok && fwrite(names.data(), 1, names.size(), f) == names.size();
+        ok = (fclose(f) == 0) && ok;
+        return ok && rename(tmp.c_str(), path.c_str()) == 0;
+    }
+};
+
+// a mapped dataset file, for queries without loading anything
+class GameDatasetView {
+public:
+    const uint64_t *moveKey = nullptr, *indexKey = nullptr, *sourceBytes = nullptr;
+    const uint32_t *moveGame = nullptr, *indexRow = nullptr;
+    const uint32_t *gameFirst = nullptr, *gameSource = nullptr, *nameOffset = nullptr;
+    const uint16_t *movePly = nullptr, *gamePlies = nullptr;
+    const int8_t   *moveCol = nullptr;
+    const uint8_t  *moveSide = nullptr, *gameResult = nullptr;
+    const char     *names = nullptr;
+
+    bool open(const string &path) {
+        if (!file.open(path) || file.size < sizeof(DatasetHeader)) return false;
+        const DatasetHeader *h = reinterpret_cast<const DatasetHeader *>(file.data);
+        if (memcmp(h->magic, "C4GD", 4) != 0 || h->version != DATASET_VERSION
+            || h->rows != uint32_t(ROWS) || h->cols != uint32_t(COLS))
+            return false;
+        header = *h;
+        size_t m = h->moves, g = h->games, s = h->sources;
+        size_t need = sizeof(DatasetHeader) + 16 * m + 8 * s + 8 * m + 8 * g + 4 * s
+                    + 2 * m + 2 * g + 2 * m + g + h->nameBytes;
+        if (file.size < need) return false;
+
+        const char *p = file.data + sizeof(DatasetHeader);
+        auto take = [&](auto *&col, size_t count) {
+            col = reinterpret_cast<decltype(col)>(p);
+            p += count * sizeof(*col);
+        };
+        take(moveKey, m); take(indexKey, m); take(sourceBytes, s);
+        take(moveGame, m); take(indexRow, m); take(gameFirst, g); take(gameSource, g);
+        take(nameOffset, s);
+        take(movePly, m); take(gamePlies, g);
+        take(moveCol, m); take(moveSide, m); take(gameResult, g);
+        names = p;
+        return true;
+    }
+
+    size_t games() const { return header.games; }
+    size_t moves() const { return header.moves; }
+    size_t sources() const { return header.sources; }
+    const char *sourceName(uint32_t s) const { return names + nameOffset[s]; }
+
+    // move rows whose position is 'key', as [first, last) into indexRow
+    pair<size_t, size_t> rowsAt(uint64_t key) const {
+        const uint64_t *lo = lower_bound(indexKey, indexKey + moves(), key);
+        const uint64_t *hi = upper_bound(lo, indexKey + moves(), key);
+        return {size_t(lo - indexKey), size_t(hi - indexKey)};
+    }
+
+    // ids of the games that reached the position 'key' (any ply)
+    vector<uint32_t> gamesReaching(uint64_t key) const {
+        vector<uint32_t> out;
+        if (key == BitPosition().key()) {   // the empty board: every game
+            for (uint32_t g = 0; g < games(); ++g) out.push_back(g);
+            return out;
+        }
+        auto r = rowsAt(key);
+        for (size_t i = r.first; i < r.second; ++i) out.push_back(moveGame[indexRow[i]]);
+        sort(out.begin(), out.end());
+        out.erase(unique(out.begin(), out.end()), out.end());
+        return out;
+    }
+
+    // copy everything back into columns (to append new logs)
+    GameDataset load() const {
+        GameDataset d;
+        d.moveKey.assign(moveKey, moveKey + moves());
+        d.moveGame.assign(moveGame, moveGame + moves());
+        d.movePly.assign(movePly, movePly + moves());
+        d.moveCol.assign(moveCol, moveCol + moves());
+        d.moveSide.assign(moveSide, moveSide + moves());
+        d.gameFirst.assign(gameFirst, gameFirst + games());
+        d.gameSource.assign(gameSource, gameSource + games());
+        d.gamePlies.assign(gamePlies, gamePlies + games());
+        d.gameResult.assign(gameResult, gameResult + games());
+        for (uint32_t s = 0; s < sources(); ++s) {
+            d.sourceName.push_back(sourceName(s));
+            d.sourceBytes.push_back(sourceBytes[s]);
+        }
+        return d;
+    }
+
+private:
+    MappedFile file;
+    DatasetHeader header{};
+};
+
+#endif // GAMELOG_H
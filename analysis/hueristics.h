@@ -1,13 +1,35 @@
 #ifndef HEURISTICS_H
 #define HEURISTICS_H
 
-#include "Board.h"
+#include "board.h"
 #include "instrumentation.h"   // include our instrumentation counters
+#include "evalcache.h"
+#include "transposition.h"
+#include "poscache.h"
+#include "book.h"
+#include "pnsearch.h"
+#include "tablebase.h"
+#include "trace.h"
+#include "tuned-weights.h"
 #include <limits>
+#include <atomic>
+#include <chrono>
+#include <functional>
 
 // Evaluation functions:
+// per-column weights of the center-bias evaluator (batcheval.h uses them
+// too): 1 at the edges, one more per column towards the middle, which is
+// {1,2,3,4,3,2,1} on the standard board
+struct ColWeights {
+    int w[COLS];
+    constexpr ColWeights() : w() {
+        for (int c = 0; c < COLS; ++c) w[c] = 1 + (c < COLS - 1 - c ? c : COLS - 1 - c);
+    }
+    constexpr int operator[](int c) const { return w[c]; }
+};
+constexpr ColWeights colWeight;
+
 inline int evaluateWithCenterBias(const Board &board) {
-    static constexpr int colWeight[COLS] = {1,2,3,4,3,2,1};
     int winResult = board.checkWin(MAX_PLAYER) ? 100000 :
                     board.checkWin(MIN_PLAYER) ? -100000 : 0;
     if (winResult) return winResult;
@@ -49,65 +71,485 @@ inline int evaluateWithSparseBias(const Board &board) {
     return score;
 }
 
-inline int minMaxAB(Board &board, int depth, int alpha, int beta, bool isMaximizer) {
+// inputs of the tuned evaluator, each as MAX's count minus MIN's. both
+// hand-made evaluators are linear in them (center bias: colWeight per
+// piece; sparse bias: one per piece plus the gap term), so a fit over them
+// can only match or improve on either.
+struct EvalFeatures {
+    int colPieces[COLS];   // pieces in each column
+    int gap;               // pieces times how far their column is below the tallest
+    int oddThreats;        // empty cells on odd rows (1st, 3rd, ... from the bottom) completing a four
+    int evenThreats;       // ... on even rows
+};
+
+inline EvalFeatures evalFeatures(const Board &board) {
+    EvalFeatures f;
+    uint64_t maxBits = board.maxBits, minBits = board.usedBits & ~board.maxBits;
+    int heights[COLS];
+    int maxHeight = 0;
+    for (int c = 0; c < COLS; ++c) {
+        heights[c] = __builtin_popcountll(board.usedBits & columnMask(c));
+        maxHeight = std::max(maxHeight, heights[c]);
+        f.colPieces[c] = __builtin_popcountll(maxBits & columnMask(c))
+                       - __builtin_popcountll(minBits & columnMask(c));
+    }
+    f.gap = 0;
+    for (int c = 0; c < COLS; ++c) f.gap += f.colPieces[c] * (maxHeight - heights[c]);
+
+    uint64_t oddRows = 0;
+    for (int r = 0; r < ROWS; r += 2) oddRows |= bottomMask() << r;
+    uint64_t maxCells = winningCells(maxBits, board.usedBits);
+    uint64_t minCells = winningCells(minBits, board.usedBits);
+    f.oddThreats  = __builtin_popcountll(maxCells & oddRows) - __builtin_popcountll(minCells & oddRows);
+    f.evenThreats = __builtin_popcountll(maxCells & ~oddRows) - __builtin_popcountll(minCells & ~oddRows);
+    return f;
+}
+
+// the tuned weights only mean something on the board they were fitted on;
+// on any other size eval=tuned is not offered (parseEvalKind)
+constexpr bool TUNED_FITS_BOARD = ROWS == TUNED_ROWS && COLS == TUNED_COLS;
+
+// linear evaluator with the weights fitted by tune-main (tuned-weights.h)
+template <bool MaxToMove>
+inline int evaluateTuned(const Board &board) {
+    int winResult = board.checkWin(MAX_PLAYER) ? 100000 :
+                    board.checkWin(MIN_PLAYER) ? -100000 : 0;
+    if (winResult) return winResult;
+
+    EvalFeatures f = evalFeatures(board);
+    int score = tunedGapWeight * f.gap + tunedOddThreat * f.oddThreats
+              + tunedEvenThreat * f.evenThreats + (MaxToMove ? tunedTempo : -tunedTempo) + tunedBias;
+    for (int c = 0; c < COLS && c < TUNED_COLS; ++c) score += tunedColWeight[c] * f.colPieces[c];
+    return score;
+}
+
+// which static evaluator the leaves use, picked at runtime and mapped once
+// per search onto one of the policy types below. EVAL_BY_SIDE is the
+// original behaviour: center bias when MAX is to move, sparse bias when MIN is.
+enum EvalKind { EVAL_BY_SIDE = 0, EVAL_CENTER = 1, EVAL_SPARSE = 2, EVAL_TUNED = 3 };
+
+// evaluator policies for the templated search. a policy provides
+//   static constexpr uint64_t id;    distinct small number, folded into table keys
+//   template <bool MaxToMove> static int evaluate(const Board &board);
+// a new evaluator is a new policy type; the search body stays as it is.
+struct CenterBiasEval {
+    static constexpr uint64_t id = EVAL_CENTER;
+    template <bool MaxToMove> static int evaluate(const Board &board) {
+        return evaluateWithCenterBias(board);
+    }
+};
+
+struct SparseBiasEval {
+    static constexpr uint64_t id = EVAL_SPARSE;
+    template <bool MaxToMove> static int evaluate(const Board &board) {
+        return evaluateWithSparseBias(board);
+    }
+};
+
+struct TunedEval {
+    static constexpr uint64_t id = EVAL_TUNED;
+    template <bool MaxToMove> static int evaluate(const Board &board) {
+        return evaluateTuned<MaxToMove>(board);
+    }
+};
+
+struct BySideEval {
+    static constexpr uint64_t id = EVAL_BY_SIDE;
+    template <bool MaxToMove> static int evaluate(const Board &board) {
+        if constexpr (MaxToMove) return evaluateWithCenterBias(board);
+        else                     return evaluateWithSparseBias(board);
+    }
+};
+
+// threat resolution at the depth horizon: instead of scoring a quiet-looking
+// leaf where the side to move can win at once, or must block, the leaf
+// search keeps playing those forcing moves until neither is left and scores
+// the position it ends in. with only one sensible move at each step the
+// line does not branch, so it costs a handful of moves per leaf; 'nodes'
+// caps it (0 turns the leaf search off, the default). set per thread, like
+// searchControl(); engineMove sets it from EngineSettings::threats.
+struct ThreatSearch {
+    uint64_t nodes = 0;
+};
+
+inline ThreatSearch &threatSearch() {
+    static thread_local ThreatSearch settings;
+    return settings;
+}
+
+// search results depend on the evaluator and on whether the threat search
+// resolves the leaves, so both are folded into table keys (evaluator id in
+// bits 52-60, TT_THREATS, then the side-to-move bit)
+template <bool MaxToMove, class Eval>
+inline uint64_t searchKey(const Board &board) {
+    return board.key() | (MaxToMove ? TT_MAX_TO_MOVE : 0) | (Eval::id << 52)
+         | (threatSearch().nodes ? TT_THREATS : 0);
+}
+
+// the same key chosen at runtime (for tools that store root results)
+inline uint64_t searchKey(const Board &board, char player, EvalKind evalKind) {
+    return board.key() | (player == MAX_PLAYER ? TT_MAX_TO_MOVE : 0) | (uint64_t(evalKind) << 52)
+         | (threatSearch().nodes ? TT_THREATS : 0);
+}
+
+// leaf evaluation through the evaluation cache
+template <bool MaxToMove, class Eval>
+inline int cachedEvaluate(const Board &board) {
+    EvalCache &cache = evalCache();
+    uint64_t key = board.key() | evalCacheTag(Eval::id, MaxToMove);
+    int score;
+    if (cache.probe(key, score)) return score;
+
+    score = Eval::template evaluate<MaxToMove>(board);
+    cache.store(key, score);
+    return score;
+}
+
+// value of a depth-0 leaf (not won, not full) after its forcing line
+template <bool MaxToMove, class Eval>
+inline int threatResolve(Board &board, uint64_t budget) {
+    constexpr char player = MaxToMove ? MAX_PLAYER : MIN_PLAYER;
+    ThreatCounters &tc = threatCounters();
+    if (budget == 0) {
+        ++tc.budgetHits;
+        return cachedEvaluate<MaxToMove, Eval>(board);
+    }
+    BitPosition pos(board, player);
+    int forced = -1;
+    for (int c = 0; c < COLS && forced < 0; ++c)
+        if (pos.canPlay(c) && pos.isWinningMove(c)) forced = c;
+    bool win = forced >= 0;
+    if (!win) {
+        // the opponent's immediate wins must be blocked (with two or more
+        // the block fails and the line ends in the opponent's four)
+        BitPosition other = pos;
+        other.toMove ^= 1;
+        for (int c = 0; c < COLS && forced < 0; ++c)
+            if (other.canPlay(c) && other.isWinningMove(c)) forced = c;
+        if (forced < 0) return cachedEvaluate<MaxToMove, Eval>(board);
+    }
+    ++tc.nodes;
+    board.makeMove(forced, player);
+    int score = (win || board.isFull())
+              ? cachedEvaluate<!MaxToMove, Eval>(board)
+              : threatResolve<!MaxToMove, Eval>(board, budget - 1);
+    board.undoMove(forced);
+    return score;
+}
+
+// a depth-0 leaf through the threat search when it is on
+template <bool MaxToMove, class Eval>
+inline int horizonValue(Board &board) {
+    uint64_t budget = threatSearch().nodes;
+    if (!budget) return cachedEvaluate<MaxToMove, Eval>(board);
+    ThreatCounters &tc = threatCounters();
+    ++tc.leaves;
+    uint64_t before = tc.nodes;
+    int score = threatResolve<MaxToMove, Eval>(board, budget);
+    tc.extended += tc.nodes != before;
+    return score;
+}
+
+// limits for the root search running on this thread. minMaxAB polls them
+// and, once one trips, unwinds without storing anything; the caller throws
+// the unfinished iteration away.
+struct SearchControl {
+    bool active = false;
+    bool aborted = false;
+    bool hasDeadline = false;
+    std::chrono::steady_clock::time_point deadline;
+    uint64_t nodeLimit = 0;                    // 0 = none
+    uint64_t nodesAtStart = 0;
+    const std::atomic<bool> *stopFlag = nullptr;
+};
+
+inline SearchControl &searchControl() {
+    static thread_local SearchControl control;
+    return control;
+}
+
+inline bool searchStopped() {
+    SearchControl &sc = searchControl();
+    if (!sc.active) return false;
+    if (sc.aborted) return true;
+    if (sc.nodeLimit && g_nodesGenerated - sc.nodesAtStart >= sc.nodeLimit)
+        sc.aborted = true;
+    else if ((g_nodesGenerated & 1023) == 0) {
+        // clock and stop flag only every 1024 nodes
+        if (sc.stopFlag && sc.stopFlag->load(std::memory_order_relaxed))
+            sc.aborted = true;
+        else if (sc.hasDeadline && std::chrono::steady_clock::now() >= sc.deadline)
+            sc.aborted = true;
+    }
+    return sc.aborted;
+}
+
+// column to try at step i: the table's best move first, then left to right
+inline int orderedColumn(int i, int ttMove) {
+    if (ttMove < 0) return i;
+    if (i == 0) return ttMove;
+    return (i <= ttMove) ? i - 1 : i;
+}
+
+// minMaxAB specialised on the side to move and the evaluator policy: each
+// combination compiles to its own search with no per-node side or
+// evaluator branches, and the recursion flips MaxToMove at compile time
+template <bool MaxToMove, class Eval>
+inline int minMaxAB(Board &board, int depth, int alpha, int beta) {
+    constexpr char player = MaxToMove ? MAX_PLAYER : MIN_PLAYER;
+
     // instrumentation: count nodes
+    // a stopped search counts no more nodes, so its count ends where it stopped
+    if (searchStopped()) return 0;
     bool isLeaf = (depth == 0) || board.checkWin(MAX_PLAYER)
                   || board.checkWin(MIN_PLAYER) || board.isFull();
     noteNode(isLeaf);
 
     if (isLeaf) {
-        return isMaximizer ? evaluateWithCenterBias(board)
-                           : evaluateWithSparseBias(board);
+        // only the threat search needs to know whether a horizon leaf is over
+        if (depth == 0 && threatSearch().nodes && !board.checkWin(MAX_PLAYER)
+            && !board.checkWin(MIN_PLAYER) && !board.isFull())
+            return horizonValue<MaxToMove, Eval>(board);
+        return cachedEvaluate<MaxToMove, Eval>(board);
     }
 
-    if (isMaximizer) {
-        int maxEval = std::numeric_limits<int>::min();
-        for (int c = 0; c < COLS; ++c) {
-            if (!board.isValidMove(c)) continue;
-            board.makeMove(c, MAX_PLAYER);
-            int eval = minMaxAB(board, depth-1, alpha, beta, false);
-            board.undoMove(c);
-            maxEval = std::max(maxEval, eval);
-            alpha = std::max(alpha, eval);
-            if (beta <= alpha) break;
+    // transposition table: take a cutoff if a deep enough result is stored,
+    // otherwise still use its best move to order the children
+    TranspositionTable &tt = transpositionTable();
+    uint64_t key = searchKey<MaxToMove, Eval>(board);
+    int ttMove = -1;
+    if (tt.enabled()) {
+        TTEntry e;
+        if (tt.probe(key, e)) {
+            if (e.depth >= depth) {
+                if (e.bound == BOUND_EXACT) return e.score;
+                if (e.bound == BOUND_LOWER && e.score >= beta) return e.score;
+                if (e.bound == BOUND_UPPER && e.score <= alpha) return e.score;
+            }
+            ttMove = e.move;
         }
-        return maxEval;
-    } else {
-        int minEval = std::numeric_limits<int>::max();
-        for (int c = 0; c < COLS; ++c) {
-            if (!board.isValidMove(c)) continue;
-            board.makeMove(c, MIN_PLAYER);
-            int eval = minMaxAB(board, depth-1, alpha, beta, true);
-            board.undoMove(c);
-            minEval = std::min(minEval, eval);
-            beta = std::min(beta, eval);
-            if (beta <= alpha) break;
+    }
+    // persistent cache: only deep nodes are kept there, so only they look
+    PositionCache &pc = positionCache();
+    bool persistent = pc.enabled() && depth >= pc.minDepth();
+    if (persistent) {
+        PosRecord r;
+        if (pc.probe(key, r)) {
+            if (r.depth >= depth) {
+                if (r.bound == BOUND_EXACT) return r.score;
+                if (r.bound == BOUND_LOWER && r.score >= beta) return r.score;
+                if (r.bound == BOUND_UPPER && r.score <= alpha) return r.score;
+            }
+            if (ttMove < 0) ttMove = r.move;
         }
-        return minEval;
     }
+    int alphaOrig = alpha, betaOrig = beta;
+    int bestCol = -1;
+    int result = MaxToMove ? std::numeric_limits<int>::min()
+                           : std::numeric_limits<int>::max();
+
+    for (int i = 0; i < COLS; ++i) {
+        int c = orderedColumn(i, ttMove);
+        if (!board.isValidMove(c)) continue;
+        board.makeMove(c, player);
+        int eval = minMaxAB<!MaxToMove, Eval>(board, depth-1, alpha, beta);
+        board.undoMove(c);
+        if (MaxToMove ? eval > result : eval < result) { result = eval; bestCol = c; }
+        if (MaxToMove) alpha = std::max(alpha, eval);
+        else           beta  = std::min(beta, eval);
+        if (beta <= alpha) break;
+    }
+    if (searchControl().aborted) return result;
+
+    TTBound bound = (result <= alphaOrig) ? BOUND_UPPER
+                  : (result >= betaOrig)  ? BOUND_LOWER
+                                          : BOUND_EXACT;
+    if (tt.enabled()) tt.store(key, result, depth, bound, bestCol);
+    if (persistent) pc.record(key, result, depth, bound, bestCol);
+    return result;
 }
 
-inline Move bestMove(Board &board, int depth, char player) {
-    int bestVal = (player == MAX_PLAYER)
-        ? std::numeric_limits<int>::min()
-        : std::numeric_limits<int>::max();
+// runtime entry point kept for callers that pick the side and evaluator on
+// the fly; dispatches once, then the whole subtree runs specialised
+inline int minMaxAB(Board &board, int depth, int alpha, int beta, bool isMaximizer,
+                    EvalKind evalKind = EVAL_BY_SIDE) {
+    switch (evalKind) {
+    case EVAL_CENTER:
+        return isMaximizer ? minMaxAB<true,  CenterBiasEval>(board, depth, alpha, beta)
+                           : minMaxAB<false, CenterBiasEval>(board, depth, alpha, beta);
+    case EVAL_SPARSE:
+        return isMaximizer ? minMaxAB<true,  SparseBiasEval>(board, depth, alpha, beta)
+                           : minMaxAB<false, SparseBiasEval>(board, depth, alpha, beta);
+    case EVAL_TUNED:
+        return isMaximizer ? minMaxAB<true,  TunedEval>(board, depth, alpha, beta)
+                           : minMaxAB<false, TunedEval>(board, depth, alpha, beta);
+    default:
+        return isMaximizer ? minMaxAB<true,  BySideEval>(board, depth, alpha, beta)
+                           : minMaxAB<false, BySideEval>(board, depth, alpha, beta);
+    }
+}
+
+// root search for the side MaxToMove with evaluator Eval; the root score
+// goes to *score when asked for
+template <bool MaxToMove, class Eval>
+inline Move bestMove(Board &board, int depth, int *score = nullptr) {
+    constexpr char player = MaxToMove ? MAX_PLAYER : MIN_PLAYER;
+    int bestVal = MaxToMove ? std::numeric_limits<int>::min()
+                            : std::numeric_limits<int>::max();
     Move bestMv{-1,-1};
+    transpositionTable().newSearch();
+    TraceSpan span("bestMove");
+    span.arg("depth", depth);
+    uint64_t nodes0 = g_nodesGenerated;
+
+    // a small-board tablebase knows the exact answer; after it the opening
+    // book, then a root already searched at least this deep in an earlier
+    // run is answered straight from the persistent cache
+    Tablebase &tb = tablebase();
+    if (tb.enabled()) {
+        int col;
+        TbValue v;
+        if (tb.bestMove(BitPosition(board, player), col, v)) {
+            bestMv.col = col;
+            int win = MaxToMove ? 100000 : -100000;
+            if (score) *score = tbIsWin(v) ? win : tbIsLoss(v) ? -win : 0;
+            span.arg("tablebase", tbPlies(v));
+            return bestMv;
+        }
+    }
+    uint64_t rootKey = searchKey<MaxToMove, Eval>(board);
+    // the book only answers searches no deeper than it was built with
+    OpeningBook &book = openingBook();
+    if (book.enabled() && book.depth() >= depth) {
+        BookEntry e;
+        if (book.probe(rootKey, e) && e.move >= 0 && board.isValidMove(e.move)) {
+            bestMv.col = e.move;
+            if (score) *score = e.score;
+            span.arg("book", 1);
+            return bestMv;
+        }
+    }
+    PositionCache &pc = positionCache();
+    if (pc.enabled() && depth >= pc.minDepth()) {
+        PosRecord r;
+        if (pc.probe(rootKey, r) && r.depth >= depth && r.bound == BOUND_EXACT
+            && r.move >= 0 && board.isValidMove(r.move)) {
+            bestMv.col = r.move;
+            if (score) *score = r.score;
+            span.arg("cached", 1);
+            return bestMv;
+        }
+    }
+    // tactical pre-check: a forced win found within the df-pn budget
+    if (dfpnPrecheck().nodes) {
+        int col = -1;
+        DfpnSolver &solver = dfpnSolver();
+        if (solver.solve(BitPosition(board, player), dfpnPrecheck().nodes, &col) == DFPN_PROVEN
+            && col >= 0) {
+            bestMv.col = col;
+            if (score) *score = MaxToMove ? 100000 : -100000;
+            span.arg("dfpn", int64_t(solver.stats.nodes));
+            return bestMv;
+        }
+    }
 
     for (int c = 0; c < COLS; ++c) {
         if (!board.isValidMove(c)) continue;
+        TraceSpan colSpan("root column");
+        uint64_t colNodes0 = g_nodesGenerated;
         board.makeMove(c, player);
-        int eval = minMaxAB(board, depth-1,
-                            std::numeric_limits<int>::min(),
-                            std::numeric_limits<int>::max(),
-                            player == MAX_PLAYER ? false : true);
+        int eval = minMaxAB<!MaxToMove, Eval>(board, depth-1,
+                                              std::numeric_limits<int>::min(),
+                                              std::numeric_limits<int>::max());
         board.undoMove(c);
-        if ((player == MAX_PLAYER && eval > bestVal) ||
-            (player == MIN_PLAYER && eval < bestVal)) {
+        if (searchControl().aborted) break;
+        colSpan.arg("col", c);
+        colSpan.arg("nodes", int64_t(g_nodesGenerated - colNodes0));
+        if (MaxToMove ? eval > bestVal : eval < bestVal) {
             bestVal = eval;
             bestMv.col = c;
         }
     }
+    span.arg("nodes", int64_t(g_nodesGenerated - nodes0));
+    span.arg("col", bestMv.col);
+    if (score) *score = bestVal;
+    // every root move got a full window, so the root score is exact
+    if (bestMv.col >= 0 && !searchControl().aborted)
+        pc.record(rootKey, bestVal, depth, BOUND_EXACT, bestMv.col);
     return bestMv;
 }
 
+inline Move bestMove(Board &board, int depth, char player, EvalKind evalKind = EVAL_BY_SIDE,
+                     int *score = nullptr) {
+    bool isMax = (player == MAX_PLAYER);
+    switch (evalKind) {
+    case EVAL_CENTER:
+        return isMax ? bestMove<true,  CenterBiasEval>(board, depth, score)
+                     : bestMove<false, CenterBiasEval>(board, depth, score);
+    case EVAL_SPARSE:
+        return isMax ? bestMove<true,  SparseBiasEval>(board, depth, score)
+                     : bestMove<false, SparseBiasEval>(board, depth, score);
+    case EVAL_TUNED:
+        return isMax ? bestMove<true,  TunedEval>(board, depth, score)
+                     : bestMove<false, TunedEval>(board, depth, score);
+    default:
+        return isMax ? bestMove<true,  BySideEval>(board, depth, score)
+                     : bestMove<false, BySideEval>(board, depth, score);
+    }
+}
+
+// per-move budget for bestMoveWithin(); zero means no limit
+struct SearchLimits {
+    int depth = 4;                 // deepest iteration
+    double timeMs = 0;             // wall-clock budget
+    uint64_t nodes = 0;            // node budget
+    const std::atomic<bool> *stop = nullptr;  // external stop request
+    // called after every finished iteration with its depth and move
+    std::function<void(int depth, const Move &mv)> onIteration;
+};
+
+// set this thread's search control up for 'limits', with the budgets
+// counted from now. it starts switched off, so the first iteration always
+// finishes (and still counts against the budget); the caller then sets
+// active, the searches stop through searchStopped(), and the caller resets
+// it with searchControl() = SearchControl()
+inline SearchControl &startSearchControl(const SearchLimits &limits) {
+    SearchControl &sc = searchControl();
+    sc = SearchControl();
+    sc.hasDeadline = limits.timeMs > 0;
+    sc.deadline = std::chrono::steady_clock::now()
+                + std::chrono::microseconds(int64_t(limits.timeMs * 1000));
+    sc.nodeLimit = limits.nodes;
+    sc.nodesAtStart = g_nodesGenerated;
+    sc.stopFlag = limits.stop;
+    return sc;
+}
+
+// iterative deepening under limits: depth 1, 2, ... up to limits.depth,
+// keeping the move (and score) of the last iteration that finished. depth
+// 1 always finishes so there is a legal move even on a tiny budget.
+inline Move bestMoveWithin(Board &board, char player, const SearchLimits &limits,
+                           EvalKind evalKind = EVAL_BY_SIDE, int *depthReached = nullptr,
+                           int *score = nullptr) {
+    SearchControl &sc = startSearchControl(limits);
+    int bestScore = 0, iterScore = 0;
+    Move best = bestMove(board, 1, player, evalKind, &bestScore);
+    int reached = 1;
+    if (limits.onIteration) limits.onIteration(1, best);
+
+    sc.active = true;
+    for (int d = 2; d <= limits.depth && !searchStopped(); ++d) {
+        Move mv = bestMove(board, d, player, evalKind, &iterScore);
+        if (sc.aborted) break;
+        best = mv;
+        bestScore = iterScore;
+        reached = d;
+        if (limits.onIteration) limits.onIteration(d, best);
+    }
+    sc = SearchControl();
+    if (depthReached) *depthReached = reached;
+    if (score) *score = bestScore;
+    return best;
+}
+
 #endif // HEURISTICS_H
@@ -0,0 +1,136 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include "board.h"
+#include "gamelog.h"
+
+// game-log dataset tool.
+//
+//   ingest-main [--data FILE] LOG...
+//       parse analysis-output-main logs into the dataset FILE (default
+//       games.c4gd), appending to it if it exists; logs already ingested
+//       (same name and size) are skipped
+//   ingest-main [--data FILE] --moves "3 3 4 ..."
+//       list the games that reached the position after these moves, X first
+//   ingest-main [--data FILE] --stats
+//       games, moves and results in the dataset
+
+using Clock = chrono::steady_clock;
+
+double msSince(Clock::time_point t0) {
+    return chrono::duration<double, milli>(Clock::now() - t0).count();
+}
+
+int ingest(const string &dataPath, const vector<string> &logs) {
+    auto t0 = Clock::now();
+    GameDataset data;
+    {
+        GameDatasetView existing;
+        if (existing.open(dataPath)) data = existing.load();
+    }
+    size_t games0 = data.games(), moves0 = data.moves(), bytes = 0, skipped = 0;
+    for (const string &path : logs) {
+        MappedFile log;
+        if (!log.open(path)) { cerr << "cannot read " << path << endl; continue; }
+        if (data.hasSource(path, log.size)) { ++skipped; continue; }
+        uint32_t source = data.addSource(path, log.size);
+        size_t bad = parseGameLog(log.data, log.size,
+                                  [&](const LoggedGame &g) { data.addGame(g, source); });
+        if (bad) cerr << path << ": " << bad << " move lines could not be replayed" << endl;
+        bytes += log.size;
+    }
+    if (!data.write(dataPath)) {
+        cerr << "could not write " << dataPath << endl;
+        return 1;
+    }
+    cout << "ingested " << (data.games() - games0) << " games, " << (data.moves() - moves0)
+         << " moves from " << (logs.size() - skipped) << " logs (" << bytes << " bytes"
+         << (skipped ? ", " + to_string(skipped) + " already present" : string()) << ") in "
+         << fixed << setprecision(2) << msSince(t0) << " ms; " << dataPath << " now holds "
+         << data.games() << " games, " << data.moves() << " moves\n";
+    return 0;
+}
+
+int query(const string &dataPath, const string &moveList) {
+    auto t0 = Clock::now();
+    GameDatasetView data;
+    if (!data.open(dataPath)) { cerr << "cannot open dataset " << dataPath << endl; return 1; }
+    double openMs = msSince(t0);
+
+    BitPosition pos;
+    stringstream ss(moveList);
+    int col;
+    while (ss >> col) {
+        if (col < 0 || col >= COLS || !pos.canPlay(col)) {
+            cerr << "illegal move " << col << endl;
+            return 1;
+        }
+        pos.play(col);
+    }
+    auto t1 = Clock::now();
+    vector<uint32_t> games = data.gamesReaching(pos.key());
+    double queryMs = msSince(t1);
+
+    cout << games.size() << " of " << data.games() << " games reach this position"
+         << " (open " << fixed << setprecision(3) << openMs << " ms, query " << queryMs << " ms)\n";
+    for (uint32_t g : games) {
+        cout << "game " << g << "  result " << char(data.gameResult[g])
+             << "  plies " << data.gamePlies[g] << "  " << data.sourceName(data.gameSource[g]) << "\n  moves";
+        for (uint32_t i = 0; i < data.gamePlies[g]; ++i)
+            cout << ' ' << int(data.moveCol[data.gameFirst[g] + i]);
+        cout << "\n";
+    }
+    return 0;
+}
+
+int stats(const string &dataPath) {
+    GameDatasetView data;
+    if (!data.open(dataPath)) { cerr << "cannot open dataset " << dataPath << endl; return 1; }
+    size_t x = 0, o = 0, d = 0, open = 0;
+    for (size_t g = 0; g < data.games(); ++g) {
+        char r = char(data.gameResult[g]);
+        if (r == MAX_PLAYER) ++x;
+        else if (r == MIN_PLAYER) ++o;
+        else if (r == GAME_DRAW) ++d;
+        else ++open;
+    }
+    cout << data.games() << " games, " << data.moves() << " moves from "
+         << data.sources() << " logs: X " << x << ", O " << o << ", draw " << d
+         << ", unfinished " << open << "\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    string dataPath = "games.c4gd", moves;
+    bool haveMoves = false, wantStats = false;
+    vector<string> logs;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--data" && i + 1 < argc)       dataPath = argv[++i];
+        else if (arg == "--moves" && i + 1 < argc) { moves = argv[++i]; haveMoves = true; }
+        else if (arg == "--stats")                 wantStats = true;
+        else if (arg.rfind("--", 0) != 0)          logs.push_back(arg);
+        else {
+            cerr << "Usage: " << argv[0] << " [--data FILE] LOG...\n"
+                 << "       " << argv[0] << " [--data FILE] --moves \"C1 C2 ...\"\n"
+                 << "       " << argv[0] << " [--data FILE] --stats" << endl;
+            return 1;
+        }
+    }
+    if (!logs.empty()) {
+        int rc = ingest(dataPath, logs);
+        if (rc) return rc;
+    }
+    if (haveMoves) return query(dataPath, moves);
+    if (wantStats) return stats(dataPath);
+    if (logs.empty()) {
+        cerr << "nothing to do; pass logs to ingest, --moves or --stats" << endl;
+        return 1;
+    }
+    return 0;
+}
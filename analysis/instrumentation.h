@@ -5,10 +5,19 @@
 #include <sys/resource.h>
 #include <chrono>
 #include <tuple>
+#include <cstdint>
+#include <cstring>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
 
-// globals to be reset before each run:
-extern uint64_t g_nodesGenerated;
-extern uint64_t g_nodesExpanded;
+// globals to be reset before each run (one set per thread, so games can
+// run in parallel):
+extern thread_local uint64_t g_nodesGenerated;
+extern thread_local uint64_t g_nodesExpanded;
 
 // call at entry of minMaxAB:
 inline void noteNode(bool isLeaf) {
@@ -16,6 +25,20 @@ inline void noteNode(bool isLeaf) {
     if (!isLeaf) ++g_nodesExpanded;
 }
 
+// threat-resolution leaf search (hueristics.h), per thread like the node
+// counters; its forcing moves are counted here, not in g_nodesGenerated
+struct ThreatCounters {
+    uint64_t leaves = 0;      // depth-0 leaves handed to the threat search
+    uint64_t extended = 0;    // ... that had at least one forcing move
+    uint64_t nodes = 0;       // forcing moves played
+    uint64_t budgetHits = 0;  // lines cut short by the node budget
+};
+
+inline ThreatCounters &threatCounters() {
+    static thread_local ThreatCounters counters;
+    return counters;
+}
+
 // wrapper to get peak RSS in KB
 inline long peakRSS_KB() {
     struct rusage ru;
@@ -23,13 +46,133 @@ inline long peakRSS_KB() {
     return ru.ru_maxrss;  
 }
 
+// user + system CPU time of the whole process (all threads) in ms
+inline double cpuTimeMs() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000.0
+         + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000.0;
+}
+
+// hardware counter totals over some span of work (a search, a game)
+struct PerfSample {
+    bool     valid = false;   // false when the counters could not be opened
+    uint64_t cycles = 0, instructions = 0;
+    uint64_t l1dMisses = 0, llcMisses = 0, branchMisses = 0;
+
+    double ipc() const { return cycles ? double(instructions) / cycles : 0.0; }
+
+    PerfSample &operator+=(const PerfSample &o) {
+        valid = valid || o.valid;
+        cycles += o.cycles; instructions += o.instructions;
+        l1dMisses += o.l1dMisses; llcMisses += o.llcMisses; branchMisses += o.branchMisses;
+        return *this;
+    }
+};
+
+// optional Linux perf_event_open counters for this process, user space only,
+// inherited by threads started after open() (the mcts workers). each event
+// is opened on its own, so a missing one (common in VMs and containers) only
+// zeroes that column; if none open, samples come back with valid == false.
+class PerfCounters {
+public:
+    enum { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, NUM_EVENTS };
+
+    ~PerfCounters() { close(); }
+
+    bool open() {
+#ifdef __linux__
+        if (opened) return available();
+        opened = true;
+        const uint32_t cacheL1dMiss = PERF_COUNT_HW_CACHE_L1D
+            | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const struct { uint32_t type; uint64_t config; } events[NUM_EVENTS] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, cacheL1dMiss},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+        for (int i = 0; i < NUM_EVENTS; ++i) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof attr);
+            attr.size = sizeof attr;
+            attr.type = events[i].type;
+            attr.config = events[i].config;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.inherit = 1;
+            fds[i] = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+        return available();
+    }
+
+    bool available() const {
+        for (int fd : fds) if (fd >= 0) return true;
+        return false;
+    }
+
+    // counters run freely; a span is the difference of two reads
+    PerfSample read() const {
+        PerfSample s;
+        s.valid = available();
+        uint64_t v[NUM_EVENTS] = {0};
+#ifdef __linux__
+        for (int i = 0; i < NUM_EVENTS; ++i)
+            if (fds[i] < 0 || ::read(fds[i], &v[i], sizeof v[i]) != sizeof v[i]) v[i] = 0;
+#endif
+        s.cycles = v[CYCLES];
+        s.instructions = v[INSTRUCTIONS];
+        s.l1dMisses = v[L1D_MISSES];
+        s.llcMisses = v[LLC_MISSES];
+        s.branchMisses = v[BRANCH_MISSES];
+        return s;
+    }
+
+    void close() {
+#ifdef __linux__
+        for (int &fd : fds) if (fd >= 0) { ::close(fd); fd = -1; }
+#endif
+    }
+
+private:
+    int fds[NUM_EVENTS] = {-1, -1, -1, -1, -1};
+    bool opened = false;
+};
+
+inline PerfSample perfDelta(const PerfSample &before, const PerfSample &after) {
+    PerfSample d;
+    d.valid = before.valid && after.valid;
+    d.cycles = after.cycles - before.cycles;
+    d.instructions = after.instructions - before.instructions;
+    d.l1dMisses = after.l1dMisses - before.l1dMisses;
+    d.llcMisses = after.llcMisses - before.llcMisses;
+    d.branchMisses = after.branchMisses - before.branchMisses;
+    return d;
+}
+
+inline PerfCounters &perfCounters() {
+    static PerfCounters counters;
+    return counters;
+}
+
 // a little struct to collect metrics
 struct Metrics {
     int minD, maxD;
     uint64_t nodesGen, nodesExp;
     double  elapsedMs;
+    double  cpuMs;        // CPU time, differs from elapsedMs with threaded engines
     long    memKB;
-    char    winner;  // 'X' or 'O' or 'D' (draw)
+    double  evalHitRate;  // evaluation cache hits / probes
+    double  ttHitRate;    // transposition table hits / probes
+    double  ttFillRate;   // share of sampled table slots written this game
+    uint64_t ttReplaced;  // entries evicted by another position (both tiers)
+    char    winner;  // 'X' or 'O' or 'D' (draw), the last game with a suite
+    PerfSample perf;      // hardware counters summed over the game's searches
+    ThreatCounters threats;  // horizon threat search, when it is on
+    int     games = 1;    // games played (one per suite position) and won by each side
+    int     maxWins = 0, minWins = 0;
 };
 
 #endif // INSTRUMENTATION_H
@@ -0,0 +1,181 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include "instrumentation.h"
+#include "board.h"
+#include "engine.h"
+#include "sprt.h"
+#include "positions.h"
+// globals
+thread_local uint64_t g_nodesGenerated = 0;
+thread_local uint64_t g_nodesExpanded  = 0;
+
+// engine-vs-engine match: engine A against engine B from varied openings,
+// each opening played twice with colors swapped, games spread over worker
+// threads, stopped early by an SPRT once the result is clear. openings are
+// every position a few plies in, or the positions of a suite file written
+// by positions-main (--suite).
+
+struct Opening {
+    Board board;
+    char player;   // side to move
+};
+
+// every distinct, still undecided position after 'plies' moves (X first),
+// in a seeded random order
+vector<Opening> makeOpenings(int plies, unsigned seed) {
+    vector<Opening> out;
+    for (uint64_t key : enumeratePositions(plies)) {
+        BitPosition pos = positionFromKey(key);
+        out.push_back({boardFromPosition(pos), playerToMove(pos)});
+    }
+    shuffle(out.begin(), out.end(), mt19937(seed));
+    return out;
+}
+
+// the positions of a suite file, in a seeded random order; false if unreadable
+bool suiteOpenings(const string &path, unsigned seed, vector<Opening> &out) {
+    SuiteHeader h;
+    vector<uint64_t> keys;
+    if (!readSuite(path, h, keys)) return false;
+    for (uint64_t key : keys) {
+        BitPosition pos = positionFromKey(key);
+        out.push_back({boardFromPosition(pos), playerToMove(pos)});
+    }
+    shuffle(out.begin(), out.end(), mt19937(seed));
+    return true;
+}
+
+// play one game from 'opening'; returns MAX_PLAYER, MIN_PLAYER or 'D'
+char playGame(const Opening &opening, const EngineSettings &xSide, const EngineSettings &oSide) {
+    Board board = opening.board;
+    char player = opening.player;
+    while (!board.isFull() && !board.checkWin(MAX_PLAYER) && !board.checkWin(MIN_PLAYER)) {
+        Move mv = engineMove(board, player, player == MAX_PLAYER ? xSide : oSide);
+        board.makeMove(mv.col, player);
+        player = (player == MAX_PLAYER) ? MIN_PLAYER : MAX_PLAYER;
+    }
+    if (board.checkWin(MAX_PLAYER)) return MAX_PLAYER;
+    if (board.checkWin(MIN_PLAYER)) return MIN_PLAYER;
+    return 'D';
+}
+
+int main(int argc, char* argv[]) {
+    EngineSettings a, b;
+    int plies = 4, maxPairs = 500, threads = int(thread::hardware_concurrency());
+    double elo0 = 0, elo1 = 20, alpha = 0.05, beta = 0.05;
+    size_t ttMB = 4;
+    unsigned seed = 1;
+    bool haveA = false, haveB = false;
+    string suitePath;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool more = i + 1 < argc;
+        if (arg == "--a" && more)            haveA = parseEngineSpec(argv[++i], a);
+        else if (arg == "--b" && more)       haveB = parseEngineSpec(argv[++i], b);
+        else if (arg == "--plies" && more)   plies = atoi(argv[++i]);
+        else if (arg == "--pairs" && more)   maxPairs = atoi(argv[++i]);
+        else if (arg == "--threads" && more) threads = atoi(argv[++i]);
+        else if (arg == "--elo0" && more)    elo0 = atof(argv[++i]);
+        else if (arg == "--elo1" && more)    elo1 = atof(argv[++i]);
+        else if (arg == "--alpha" && more)   alpha = atof(argv[++i]);
+        else if (arg == "--beta" && more)    beta = atof(argv[++i]);
+        else if (arg == "--tt-mb" && more)   ttMB = atol(argv[++i]);
+        else if (arg == "--seed" && more)    seed = unsigned(atol(argv[++i]));
+        else if (arg == "--suite" && more)   suitePath = argv[++i];
+        else { haveA = false; break; }
+    }
+    if (!haveA || !haveB) {
+        cerr << "Usage: " << argv[0] << " --a SPEC --b SPEC [--plies N] [--pairs N]"
+             << " [--threads N] [--elo0 E] [--elo1 E] [--alpha A] [--beta B]"
+             << " [--tt-mb N] [--seed S] [--suite FILE]\n"
+             << "  SPEC: key=value list, keys engine (minmax|mcts), depth,"
+             << " eval (side|center|sparse|tuned), ms, playouts, threads, threats\n"
+             << "  e.g. --a depth=6,eval=center --b depth=4,ms=20" << endl;
+        return 1;
+    }
+    if (threads < 1) threads = 1;
+
+    vector<Opening> openings;
+    string from = " at " + to_string(plies) + " plies";
+    if (suitePath.empty()) {
+        openings = makeOpenings(plies, seed);
+    } else if (suiteOpenings(suitePath, seed, openings)) {
+        from = " from " + suitePath;
+    } else {
+        cerr << "cannot read suite " << suitePath << endl;
+        return 1;
+    }
+    if (openings.empty()) {
+        cerr << "no undecided openings" << from << endl;
+        return 1;
+    }
+    // a fixed-depth engine plays an opening the same way every time, so a
+    // replayed opening would count one game as several; each opening is
+    // used for one pair at most
+    bool openingsLimit = int(openings.size()) < maxPairs;
+    if (openingsLimit) maxPairs = int(openings.size());
+    cout << "A: " << engineSpecString(a) << "\n"
+         << "B: " << engineSpecString(b) << "\n"
+         << openings.size() << " openings" << from << ", "
+         << threads << " threads, SPRT elo0=" << elo0 << " elo1=" << elo1
+         << " alpha=" << alpha << " beta=" << beta << "\n";
+
+    Sprt sprt(elo0, elo1, alpha, beta);
+    mutex mtx;
+    atomic<int> nextPair{0};
+    atomic<bool> decided{false};
+    SprtDecision verdict = SPRT_CONTINUE;
+
+    auto score = [](char winner, char aColor) {
+        return winner == 'D' ? 0.5 : (winner == aColor ? 1.0 : 0.0);
+    };
+
+    auto worker = [&]() {
+        transpositionTable().resize(ttMB);
+        while (!decided.load()) {
+            int pair = nextPair.fetch_add(1);
+            if (pair >= maxPairs) break;
+            const Opening &opening = openings[pair];
+            double s1 = score(playGame(opening, a, b), MAX_PLAYER);  // A plays X
+            double s2 = score(playGame(opening, b, a), MIN_PLAYER);  // A plays O
+
+            lock_guard<mutex> lock(mtx);
+            if (verdict != SPRT_CONTINUE) break;
+            sprt.add(s1);
+            sprt.add(s2);
+            verdict = sprt.decision();
+            cout << "games " << setw(5) << sprt.games()
+                 << "  +" << sprt.wins << " =" << sprt.draws << " -" << sprt.losses
+                 << "  elo " << fixed << setprecision(1) << sprt.elo()
+                 << "  LLR " << setprecision(2) << sprt.llr()
+                 << " [" << sprt.lower() << ", " << sprt.upper() << "]\n";
+            if (verdict != SPRT_CONTINUE) decided.store(true);
+        }
+    };
+
+    double cpu0 = cpuTimeMs();
+    auto t0 = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool) t.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    cout << (verdict == SPRT_ACCEPT_H1 ? "H1 accepted: A is stronger by at least elo1"
+           : verdict == SPRT_ACCEPT_H0 ? "H0 accepted: A is not stronger by elo1"
+                                       : openingsLimit ? "inconclusive: openings exhausted"
+                                       : "inconclusive: game limit reached")
+         << " after " << sprt.games() << " games, "
+         << setprecision(1) << secs << " s wall, "
+         << (cpuTimeMs() - cpu0) / 1000.0 << " s cpu\n";
+    return 0;
+}
@@ -0,0 +1,276 @@
+// mcts.h
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "board.h"
+#include "trace.h"
+
+// monte carlo tree search engine, the alternative to minMaxAB/bestMove.
+// UCT selection, random (optionally lightly biased) playouts on bitboards,
+// and every tree node lives in one preallocated arena. with several threads
+// they all grow the same tree; a thread walking down a path adds a virtual
+// loss to each node so the others spread out instead of piling onto it.
+
+struct MctsLimits {
+    uint64_t playouts = 20000;   // stop after this many playouts (0 = no limit)
+    double   timeMs   = 0;       // stop after this much wall time (0 = no limit);
+                                 // with both 0 the default playout count applies
+    int      threads  = 1;
+    size_t   maxNodes = 1 << 18; // arena capacity; the tree stops growing when full
+    double   explore  = 1.41;    // UCT exploration constant
+    bool     biased   = true;    // playouts take wins and block losses
+    const std::atomic<bool> *stop = nullptr;  // external stop request
+};
+
+struct MctsStats {
+    uint64_t playouts = 0;
+    size_t   nodes    = 0;
+    double   elapsedMs = 0;
+    double   rootValue = 0;      // best child's mean reward for the side to move, 0..1
+};
+
+// rewards are stored doubled so draws stay integral: win 2, draw 1, loss 0
+const int MCTS_VIRTUAL_LOSS = 1;
+
+struct MctsNode {
+    std::atomic<int32_t> visits{0};
+    std::atomic<int32_t> reward{0};      // for the player who moved into this node
+    std::atomic<int32_t> virtualLoss{0};
+    std::atomic<int32_t> firstChild{-1};
+    std::atomic<uint8_t> state{0};       // 0 leaf, 1 being expanded, 2 expanded
+    int8_t move = -1;                    // column that led here
+    int8_t childCount = 0;
+    int8_t winner = -1;                  // terminal: 0/1 who won, 2 draw, -1 not terminal
+};
+
+class MctsArena {
+public:
+    explicit MctsArena(size_t capacity) : nodes(new MctsNode[capacity]), cap(capacity) {}
+
+    // reserve 'count' consecutive nodes, -1 when the arena is full
+    int32_t allocate(int count) {
+        size_t at = used.fetch_add(count, std::memory_order_relaxed);
+        if (at + count > cap) return -1;
+        return int32_t(at);
+    }
+
+    MctsNode &operator[](int32_t i) { return nodes[i]; }
+    size_t size() const { size_t u = used.load(); return u < cap ? u : cap; }
+
+private:
+    std::unique_ptr<MctsNode[]> nodes;
+    size_t cap;
+    std::atomic<size_t> used{0};
+};
+
+// xorshift64*, one per thread
+struct MctsRng {
+    uint64_t s;
+    explicit MctsRng(uint64_t seed) : s(seed ? seed : 0x9E3779B97F4A7C15ULL) {}
+    uint32_t next() {
+        s ^= s >> 12; s ^= s << 25; s ^= s >> 27;
+        return uint32_t((s * 0x2545F4914F6CDD1DULL) >> 32);
+    }
+};
+
+// play 'pos' out to the end; returns 0/1 for the winner or 2 for a draw
+inline int mctsPlayout(BitPosition pos, MctsRng &rng, bool biased) {
+    while (!pos.isFull()) {
+        int legal[COLS], n = 0;
+        for (int c = 0; c < COLS; ++c)
+            if (pos.canPlay(c)) legal[n++] = c;
+
+        int pick = -1;
+        if (biased) {
+            // take a win, else block the opponent's
+            for (int i = 0; i < n && pick < 0; ++i)
+                if (pos.isWinningMove(legal[i])) return pos.toMove;
+            uint64_t theirs = pos.stones[pos.toMove ^ 1];
+            for (int i = 0; i < n && pick < 0; ++i)
+                if (hasFour(theirs | pos.moveBit(legal[i]))) pick = legal[i];
+        }
+        if (pick < 0) {
+            pick = legal[rng.next() % n];
+            if (!biased && pos.isWinningMove(pick)) return pos.toMove;
+        }
+        pos.play(pick);
+    }
+    return 2;
+}
+
+class MctsSearch {
+public:
+    MctsSearch(const BitPosition &root, const MctsLimits &lim)
+        : rootPos(root), limits(lim), arena(lim.maxNodes) {
+        // with neither budget set nothing would end the search; fall back
+        // to the default playout count
+        if (!limits.playouts && limits.timeMs <= 0) limits.playouts = MctsLimits().playouts;
+        arena.allocate(1);
+    }
+
+    // run the search on limits.threads threads; returns the most visited column
+    int run(MctsStats *stats = nullptr) {
+        auto t0 = std::chrono::steady_clock::now();
+        deadline = t0 + std::chrono::microseconds(int64_t(limits.timeMs * 1000));
+
+        int n = limits.threads > 0 ? limits.threads : 1;
+        std::vector<std::thread> pool;
+        for (int t = 1; t < n; ++t)
+            pool.emplace_back([this, t] { worker(t); });
+        worker(0);
+        for (auto &th : pool) th.join();
+
+        int best = -1;
+        int32_t bestVisits = -1;
+        double bestValue = 0;
+        MctsNode &root = arena[0];
+        int32_t first = root.firstChild.load(std::memory_order_acquire);
+        for (int i = 0; first >= 0 && i < root.childCount; ++i) {
+            MctsNode &ch = arena[first + i];
+            int32_t v = ch.visits.load();
+            if (v > bestVisits) {
+                bestVisits = v;
+                best = ch.move;
+                bestValue = v ? ch.reward.load() / (2.0 * v) : 0;
+            }
+        }
+        if (stats) {
+            stats->playouts  = playoutsDone.load();
+            stats->nodes     = arena.size();
+            stats->elapsedMs = std::chrono::duration<double, std::milli>(
+                                   std::chrono::steady_clock::now() - t0).count();
+            stats->rootValue = bestValue;
+        }
+        return best;
+    }
+
+private:
+    BitPosition rootPos;
+    MctsLimits limits;
+    MctsArena arena;
+    std::atomic<uint64_t> playoutsDone{0};
+    std::atomic<bool> done{false};
+    std::chrono::steady_clock::time_point deadline;
+
+    bool outOfBudget(uint64_t playouts) {
+        if (done.load(std::memory_order_relaxed)) return true;
+        // a stop request still lets one playout through, so there is a move
+        bool out = (limits.stop && playouts > 0 && limits.stop->load(std::memory_order_relaxed))
+                || (limits.playouts && playouts >= limits.playouts)
+                || (limits.timeMs > 0 && (playouts & 63) == 0
+                    && std::chrono::steady_clock::now() >= deadline);
+        if (out) done.store(true, std::memory_order_relaxed);
+        return out;
+    }
+
+    // create all children of 'node' at once; only one thread gets to do it
+    void expand(MctsNode &node, const BitPosition &pos) {
+        uint8_t expected = 0;
+        if (!node.state.compare_exchange_strong(expected, 1)) return;
+
+        int cols[COLS], n = 0;
+        for (int c = 0; c < COLS; ++c)
+            if (pos.canPlay(c)) cols[n++] = c;
+        int32_t first = arena.allocate(n);
+        if (first < 0) { node.state.store(0); return; }
+
+        for (int i = 0; i < n; ++i) {
+            MctsNode &ch = arena[first + i];
+            ch.move = int8_t(cols[i]);
+            if (pos.isWinningMove(cols[i]))       ch.winner = int8_t(pos.toMove);
+            else if (pos.moves + 1 == ROWS * COLS) ch.winner = 2;
+        }
+        node.childCount = int8_t(n);
+        node.firstChild.store(first, std::memory_order_release);
+        node.state.store(2, std::memory_order_release);
+    }
+
+    // UCT over the children of an expanded node, virtual losses included
+    int32_t select(MctsNode &node) {
+        int32_t first = node.firstChild.load(std::memory_order_acquire);
+        int32_t parentN = node.visits.load(std::memory_order_relaxed)
+                        + node.virtualLoss.load(std::memory_order_relaxed);
+        double logN = std::log(double(parentN > 0 ? parentN : 1));
+        int32_t best = first;
+        double bestScore = -1;
+        for (int i = 0; i < node.childCount; ++i) {
+            MctsNode &ch = arena[first + i];
+            int32_t n = ch.visits.load(std::memory_order_relaxed)
+                      + ch.virtualLoss.load(std::memory_order_relaxed);
+            if (n == 0) return first + i;
+            double q = ch.reward.load(std::memory_order_relaxed) / (2.0 * n);
+            double score = q + limits.explore * std::sqrt(logN / n);
+            if (score > bestScore) { bestScore = score; best = first + i; }
+        }
+        return best;
+    }
+
+    void worker(int id) {
+        MctsRng rng(0xC0FFEEULL * (id + 1) ^ rootPos.key());
+        int32_t path[ROWS * COLS + 2];
+        TraceSpan span("mcts worker");
+        int64_t mine = 0;
+
+        while (!outOfBudget(playoutsDone.load(std::memory_order_relaxed))) {
+            BitPosition pos = rootPos;
+            int len = 0;
+            int32_t cur = 0;
+            path[len++] = cur;
+            arena[cur].virtualLoss.fetch_add(MCTS_VIRTUAL_LOSS, std::memory_order_relaxed);
+
+            // selection: walk expanded nodes down to a leaf
+            while (arena[cur].winner < 0 && arena[cur].state.load(std::memory_order_acquire) == 2) {
+                cur = select(arena[cur]);
+                pos.play(arena[cur].move);
+                path[len++] = cur;
+                arena[cur].virtualLoss.fetch_add(MCTS_VIRTUAL_LOSS, std::memory_order_relaxed);
+            }
+
+            // expansion once a leaf has been visited before, then simulate
+            MctsNode &leaf = arena[cur];
+            int winner = leaf.winner;
+            if (winner < 0) {
+                if (leaf.visits.load(std::memory_order_relaxed) > 0 || cur == 0)
+                    expand(leaf, pos);
+                winner = mctsPlayout(pos, rng, limits.biased);
+            }
+
+            // backpropagation: node i was entered by the player who moved at ply i-1
+            for (int i = len - 1; i >= 0; --i) {
+                MctsNode &node = arena[path[i]];
+                int mover = (rootPos.toMove + i - 1) & 1;
+                int r = (winner == 2) ? 1 : (winner == mover ? 2 : 0);
+                node.reward.fetch_add(r, std::memory_order_relaxed);
+                node.visits.fetch_add(1, std::memory_order_relaxed);
+                node.virtualLoss.fetch_sub(MCTS_VIRTUAL_LOSS, std::memory_order_relaxed);
+            }
+            playoutsDone.fetch_add(1, std::memory_order_relaxed);
+            ++mine;
+        }
+        span.arg("thread", id);
+        span.arg("playouts", mine);
+    }
+};
+
+// pick a move for 'player' with MCTS
+inline Move mctsBestMove(const Board &board, char player, const MctsLimits &limits,
+                         MctsStats *stats = nullptr) {
+    TraceSpan span("mctsBestMove");
+    MctsSearch search(BitPosition(board, player), limits);
+    Move mv{-1, -1};
+    MctsStats local;
+    mv.col = search.run(&local);
+    span.arg("playouts", int64_t(local.playouts));
+    span.arg("nodes", int64_t(local.nodes));
+    span.arg("col", mv.col);
+    if (stats) *stats = local;
+    return mv;
+}
+
+#endif // MCTS_H
@@ -0,0 +1,184 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <limits>
+#include <chrono>
+#include <algorithm>
+#include "instrumentation.h"
+#include "board.h"
+#include "engine.h"
+#include "multipv.h"
+#include "positions.h"
+// globals
+thread_local uint64_t g_nodesGenerated = 0;
+thread_local uint64_t g_nodesExpanded  = 0;
+
+// multi-PV search against what it replaces. for each position the top K
+// root moves are found three ways, each from empty tables:
+//   separate    K root searches, the i-th over the moves the first i-1 did
+//               not pick (what tools did before: one search per wanted move)
+//   all exact   one bestMove-style pass, a full window for every root move
+//   multi-PV    multiPV(), full windows only while a move can make the top K
+// and the multi-PV scores are checked against the all-exact ones.
+//
+//   multipv-bench [--depth D] [--k K] [--positions N] [--suite FILE]
+//                 [--eval side|center|sparse|tuned] [--tt-mb N]
+
+using Clock = chrono::steady_clock;
+
+struct Cost {
+    uint64_t nodes = 0;
+    double ms = 0;
+};
+
+void freshTables(size_t ttMB) {
+    transpositionTable().resize(ttMB);
+    evalCache().clear();
+}
+
+// exact score of every root move allowed by 'skip', full windows as in bestMove
+vector<pair<int,int>> rootScores(Board &board, char player, int depth, EvalKind eval,
+                                 const vector<int> &skip = {}) {
+    vector<pair<int,int>> scores;
+    transpositionTable().newSearch();
+    for (int c = 0; c < COLS; ++c) {
+        if (!board.isValidMove(c) || find(skip.begin(), skip.end(), c) != skip.end()) continue;
+        board.makeMove(c, player);
+        int v = minMaxAB(board, depth - 1, numeric_limits<int>::min(), numeric_limits<int>::max(),
+                         player != MAX_PLAYER, eval);
+        board.undoMove(c);
+        scores.push_back({c, v});
+    }
+    return scores;
+}
+
+int bestOf(const vector<pair<int,int>> &scores, char player) {
+    int best = -1, val = 0;
+    for (auto &s : scores)
+        if (best < 0 || (player == MAX_PLAYER ? s.second > val : s.second < val)) { best = s.first; val = s.second; }
+    return best;
+}
+
+template <class Fn>
+Cost measure(size_t ttMB, Fn fn) {
+    freshTables(ttMB);
+    uint64_t n0 = g_nodesGenerated;
+    auto t0 = Clock::now();
+    fn();
+    return {g_nodesGenerated - n0, chrono::duration<double, milli>(Clock::now() - t0).count()};
+}
+
+// varied positions: a few scripted moves each, skipping any already decided
+vector<pair<Board,char>> scriptedPositions(int n) {
+    vector<pair<Board,char>> out;
+    for (int g = 0; int(out.size()) < n && g < 50 * n; ++g) {
+        Board board;
+        char player = MAX_PLAYER;
+        bool over = false;
+        for (int m = 0; m < 2 + g % 9 && !over; ++m) {
+            int c = (m * 5 + g * 3 + m * g) % COLS;
+            if (!board.isValidMove(c)) continue;
+            board.makeMove(c, player);
+            over = board.checkWin(player) || board.isFull();
+            player = (player == MAX_PLAYER) ? MIN_PLAYER : MAX_PLAYER;
+        }
+        if (!over) out.push_back({board, player});
+    }
+    return out;
+}
+
+int main(int argc, char* argv[]) {
+    int depth = 8, k = 3, count = 20;
+    size_t ttMB = 16;
+    EvalKind eval = EVAL_BY_SIDE;
+    string suitePath;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool more = i + 1 < argc;
+        if (arg == "--depth" && more)          depth = atoi(argv[++i]);
+        else if (arg == "--k" && more)         k = atoi(argv[++i]);
+        else if (arg == "--positions" && more) count = atoi(argv[++i]);
+        else if (arg == "--suite" && more)     suitePath = argv[++i];
+        else if (arg == "--tt-mb" && more)     ttMB = atol(argv[++i]);
+        else if (arg == "--eval" && more && parseEvalKind(argv[i+1], eval)) ++i;
+        else {
+            cerr << "Usage: " << argv[0] << " [--depth D] [--k K] [--positions N] [--suite FILE]"
+                 << " [--eval side|center|sparse|tuned] [--tt-mb N]" << endl;
+            return 1;
+        }
+    }
+    if (depth < 1 || k < 1 || count < 1) { cerr << "nothing to run" << endl; return 1; }
+    evalCache().resize(256);
+
+    vector<pair<Board,char>> positions;
+    if (suitePath.empty()) {
+        positions = scriptedPositions(count);
+    } else {
+        SuiteHeader h;
+        vector<uint64_t> keys;
+        if (!readSuite(suitePath, h, keys)) { cerr << "cannot read suite " << suitePath << endl; return 1; }
+        for (size_t i = 0; i < keys.size() && int(positions.size()) < count; ++i) {
+            BitPosition pos = positionFromKey(keys[i]);
+            positions.push_back({boardFromPosition(pos), pos.toMove == 0 ? MAX_PLAYER : MIN_PLAYER});
+        }
+    }
+
+    cout << positions.size() << " positions, depth " << depth << ", top " << k << " moves, "
+         << evalName(eval) << " eval\n\n" << left
+         << setw(5) << "pos" << setw(14) << "separate" << setw(14) << "all exact"
+         << setw(14) << "multi-PV" << "top moves (col:score)\n";
+    Cost separate, allExact, multi;
+    int mismatches = 0;
+    for (size_t p = 0; p < positions.size(); ++p) {
+        Board board = positions[p].first;
+        char player = positions[p].second;
+
+        Cost s = measure(ttMB, [&] {
+            vector<int> picked;
+            for (int i = 0; i < k; ++i) {
+                freshTables(ttMB);
+                int c = bestOf(rootScores(board, player, depth, eval, picked), player);
+                if (c < 0) break;
+                picked.push_back(c);
+            }
+        });
+        vector<pair<int,int>> exact;
+        Cost a = measure(ttMB, [&] { exact = rootScores(board, player, depth, eval); });
+        vector<RootLine> lines;
+        SearchLimits limits;
+        limits.depth = depth;
+        Cost m = measure(ttMB, [&] { lines = multiPV(board, player, limits, k, eval); });
+
+        // the multi-PV scores must be the exact ones, and the best k of them
+        vector<int> want;
+        for (auto &e : exact) want.push_back(e.second);
+        sort(want.begin(), want.end());
+        if (player == MAX_PLAYER) reverse(want.begin(), want.end());
+        want.resize(min<size_t>(k, want.size()));
+        bool ok = lines.size() == want.size();
+        for (size_t i = 0; ok && i < lines.size(); ++i) {
+            auto it = find_if(exact.begin(), exact.end(), [&](const pair<int,int> &e) { return e.first == lines[i].col; });
+            ok = it != exact.end() && it->second == lines[i].score && lines[i].score == want[i];
+        }
+        mismatches += !ok;
+
+        separate.nodes += s.nodes; separate.ms += s.ms;
+        allExact.nodes += a.nodes; allExact.ms += a.ms;
+        multi.nodes += m.nodes;    multi.ms += m.ms;
+        cout << setw(5) << p << setw(14) << s.nodes << setw(14) << a.nodes << setw(14) << m.nodes;
+        for (const RootLine &l : lines) cout << l.col << ":" << l.score << " ";
+        cout << (ok ? "" : " MISMATCH") << "\n";
+    }
+    auto ratio = [](const Cost &c, const Cost &base) { return base.nodes ? double(c.nodes) / base.nodes : 0.0; };
+    cout << fixed << setprecision(1) << "\n"
+         << setw(12) << "separate" << setw(14) << separate.nodes << setw(10) << separate.ms << " ms\n"
+         << setw(12) << "all exact" << setw(14) << allExact.nodes << setw(10) << allExact.ms << " ms\n"
+         << setw(12) << "multi-PV" << setw(14) << multi.nodes << setw(10) << multi.ms << " ms\n"
+         << setprecision(3) << "multi-PV nodes: " << ratio(multi, separate) << "x separate, "
+         << ratio(multi, allExact) << "x all exact; "
+         << (mismatches ? to_string(mismatches) + " MISMATCHES" : string("all scores exact")) << "\n";
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,165 @@
+// multipv.h
+#ifndef MULTIPV_H
+#define MULTIPV_H
+
+#include <cstdint>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include "board.h"
+#include "hueristics.h"
+
+// multi-PV root search: the K best root moves, each with an exact score
+// and its principal variation, for analysis tools that want more than the
+// one move bestMove plays.
+//
+// bestMove already gives every root move a full window, so all its scores
+// are exact, and all of them cost a full search. here a root move only
+// needs an exact score while it could still make the top K: once K moves
+// are scored, the rest are searched with the K-th score as the bound, and
+// one that fails low is provably outside the top K after a cheap refutation.
+// iterative deepening orders the root moves by the previous depth's scores,
+// so the strong moves come first and set the bound early, and the tables
+// carry move ordering from one depth and one root move to the next.
+
+struct RootLine {
+    int col = -1;
+    int score = 0;
+    std::vector<int> pv;   // starts with col
+};
+
+// the principal variation after playing 'col', read back from the
+// transposition table: follow each position's stored best move as long as
+// there is one and the game is not over, up to 'length' moves
+template <bool MaxToMove, class Eval>
+inline std::vector<int> tablePV(Board board, int col, int length) {
+    std::vector<int> pv{col};
+    bool maxToMove = MaxToMove;
+    board.makeMove(col, maxToMove ? MAX_PLAYER : MIN_PLAYER);
+    maxToMove = !maxToMove;
+    TranspositionTable &tt = transpositionTable();
+    while (int(pv.size()) < length && tt.enabled()) {
+        char mover = maxToMove ? MAX_PLAYER : MIN_PLAYER;
+        char other = maxToMove ? MIN_PLAYER : MAX_PLAYER;
+        if (board.isFull() || board.checkWin(other)) break;
+        TTEntry e;
+        uint64_t key = searchKey(board, mover, EvalKind(Eval::id));
+        if (!tt.probe(key, e) || e.move < 0 || !board.isValidMove(e.move)) break;
+        board.makeMove(e.move, mover);
+        pv.push_back(e.move);
+        maxToMove = !maxToMove;
+    }
+    return pv;
+}
+
+// one depth of the multi-PV search. 'order' lists the root columns to try,
+// best first; on return 'lines' holds the top min(k, legal moves) of them,
+// best first, and 'order' all of them re-ranked (moves that failed low keep
+// their relative order behind the scored ones). false if the search was
+// stopped, and then both are half-updated.
+template <bool MaxToMove, class Eval>
+inline bool multiPVDepth(Board &board, int depth, int k, std::vector<int> &order,
+                         std::vector<RootLine> &lines) {
+    constexpr char player = MaxToMove ? MAX_PLAYER : MIN_PLAYER;
+    const int inf = std::numeric_limits<int>::max(), ninf = std::numeric_limits<int>::min();
+    auto better = [](int a, int b) { return MaxToMove ? a > b : a < b; };
+    transpositionTable().newSearch();
+
+    std::vector<RootLine> top;   // kept sorted, best first
+    std::vector<int> failed;
+    for (int c : order) {
+        // full window until k moves are scored, then only "better than the k-th"
+        bool bounded = int(top.size()) >= k;
+        int bound = bounded ? top.back().score : 0;
+        int alpha = (MaxToMove && bounded) ? bound : ninf;
+        int beta  = (!MaxToMove && bounded) ? bound : inf;
+        board.makeMove(c, player);
+        int eval = minMaxAB<!MaxToMove, Eval>(board, depth - 1, alpha, beta);
+        board.undoMove(c);
+        if (searchControl().aborted) return false;
+        if (bounded && !better(eval, bound)) { failed.push_back(c); continue; }
+
+        RootLine line;
+        line.col = c;
+        line.score = eval;
+        auto at = std::find_if(top.begin(), top.end(), [&](const RootLine &l) { return better(eval, l.score); });
+        top.insert(at, line);
+        if (int(top.size()) > k) {
+            failed.insert(failed.begin(), top.back().col);
+            top.pop_back();
+        }
+    }
+    order.clear();
+    for (RootLine &l : top) {
+        l.pv = tablePV<MaxToMove, Eval>(board, l.col, depth);
+        order.push_back(l.col);
+    }
+    order.insert(order.end(), failed.begin(), failed.end());
+    lines.swap(top);
+    return true;
+}
+
+// called after every finished depth with that depth's lines
+typedef std::function<void(int depth, const std::vector<RootLine> &lines)> MultiPVCallback;
+
+// the k best root moves of the side MaxToMove, best first, deepening to
+// limits.depth under the limits like bestMoveWithin: the lines of the last
+// depth that finished are returned, and depth 1 always finishes.
+// limits.onIteration sees the best line's move.
+template <bool MaxToMove, class Eval>
+inline std::vector<RootLine> multiPV(Board &board, const SearchLimits &limits, int k,
+                                     int *depthReached = nullptr,
+                                     const MultiPVCallback &onDepth = nullptr) {
+    std::vector<int> order;
+    for (int c = 0; c < COLS; ++c)
+        if (board.isValidMove(c)) order.push_back(c);
+    std::vector<RootLine> lines;
+    if (k < 1) k = 1;
+    auto finished = [&](int d) {
+        Move mv{-1, lines.empty() ? -1 : lines[0].col};
+        if (limits.onIteration) limits.onIteration(d, mv);
+        if (onDepth) onDepth(d, lines);
+    };
+    SearchControl &sc = startSearchControl(limits);
+    multiPVDepth<MaxToMove, Eval>(board, 1, k, order, lines);
+    int reached = 1;
+    finished(1);
+
+    sc.active = true;
+    for (int d = 2; d <= limits.depth && !searchStopped(); ++d) {
+        std::vector<int> nextOrder = order;
+        std::vector<RootLine> next;
+        if (!multiPVDepth<MaxToMove, Eval>(board, d, k, nextOrder, next)) break;
+        order.swap(nextOrder);
+        lines.swap(next);
+        reached = d;
+        finished(d);
+    }
+    sc = SearchControl();
+    if (depthReached) *depthReached = reached;
+    return lines;
+}
+
+// the same with the side and evaluator picked at runtime
+inline std::vector<RootLine> multiPV(Board &board, char player, const SearchLimits &limits, int k,
+                                     EvalKind evalKind = EVAL_BY_SIDE, int *depthReached = nullptr,
+                                     const MultiPVCallback &onDepth = nullptr) {
+    bool isMax = (player == MAX_PLAYER);
+    switch (evalKind) {
+    case EVAL_CENTER:
+        return isMax ? multiPV<true,  CenterBiasEval>(board, limits, k, depthReached, onDepth)
+                     : multiPV<false, CenterBiasEval>(board, limits, k, depthReached, onDepth);
+    case EVAL_SPARSE:
+        return isMax ? multiPV<true,  SparseBiasEval>(board, limits, k, depthReached, onDepth)
+                     : multiPV<false, SparseBiasEval>(board, limits, k, depthReached, onDepth);
+    case EVAL_TUNED:
+        return isMax ? multiPV<true,  TunedEval>(board, limits, k, depthReached, onDepth)
+                     : multiPV<false, TunedEval>(board, limits, k, depthReached, onDepth);
+    default:
+        return isMax ? multiPV<true,  BySideEval>(board, limits, k, depthReached, onDepth)
+                     : multiPV<false, BySideEval>(board, limits, k, depthReached, onDepth);
+    }
+}
+
+#endif // MULTIPV_H
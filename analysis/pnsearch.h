@@ -0,0 +1,318 @@
+// pnsearch.h
+#ifndef PNSEARCH_H
+#define PNSEARCH_H
+
+#include <cstdint>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include "board.h"
+
+// depth-first proof-number search (df-pn): proves or disproves that one
+// side (the attacker) can force a win from a position. unlike alpha-beta
+// it has no depth limit and no evaluator; it spends its effort wherever
+// the fewest leaves are left to settle, which is what deciding won/lost
+// positions needs.
+//
+// the phi/delta form is used: at every node phi is the proof number for
+// the side to move reaching its goal there (the attacker winning, or the
+// defender stopping that) and delta the number for it failing, so a node
+// is phi = min(delta of children), delta = sum(phi of children) no matter
+// whose turn it is. results go to a bounded table (fixed size, smallest
+// amount of work evicted first), so memory stays flat on hard positions
+// at the cost of some re-search.
+
+enum DfpnResult { DFPN_UNKNOWN = 0, DFPN_PROVEN = 1, DFPN_DISPROVEN = 2 };
+
+const uint32_t DFPN_INF = 1u << 30;
+const int DFPN_BUCKET_SLOTS = 4;
+
+struct DfpnEntry {
+    uint64_t key = 0;       // position key | attacker bit, 0 = empty
+    uint32_t phi = 1, delta = 1;
+    uint64_t work = 0;      // nodes spent below this entry, for replacement
+};
+
+struct DfpnStats {
+    uint64_t nodes = 0;         // mid() calls
+    uint64_t lookups = 0, hits = 0, stores = 0, evictions = 0;
+    uint64_t proofSize = 0;     // distinct positions in the proof (or disproof) tree
+    bool proofComplete = true;  // false when part of the tree was evicted
+};
+
+class DfpnSolver {
+public:
+    DfpnStats stats;
+
+    explicit DfpnSolver(size_t tableMB = 16) { resize(tableMB); }
+
+    void resize(size_t tableMB) {
+        size_t n = 1;
+        while (n * 2 * DFPN_BUCKET_SLOTS * sizeof(DfpnEntry) <= tableMB * 1024 * 1024) n *= 2;
+        table.assign(n * DFPN_BUCKET_SLOTS, DfpnEntry());
+        mask = n - 1;
+    }
+
+    void clear() { fill(table.begin(), table.end(), DfpnEntry()); }
+
+    // can 'attackerSide' (0 = MAX_PLAYER, 1 = MIN_PLAYER) force a win from
+    // 'pos', whoever is to move? nodeLimit 0 means no limit; if it runs out
+    // the answer is DFPN_UNKNOWN. stats.proofSize is the size of the proof
+    // (or, when disproven, of the disproof) found.
+    DfpnResult solveFor(const BitPosition &pos, int attackerSide, uint64_t nodeLimit = 0) {
+        stats = DfpnStats();
+        limit = nodeLimit;
+        attacker = attackerSide;
+        aborted = false;
+        mid(pos, DFPN_INF - 1, DFPN_INF - 1);
+        DfpnEntry root = lookup(pos);
+        if (aborted || (root.phi != 0 && root.delta != 0)) return DFPN_UNKNOWN;
+
+        // phi is from the side to move's view
+        bool proven = (pos.toMove == attacker) ? root.phi == 0 : root.delta == 0;
+        unordered_set<uint64_t> seen;
+        stats.proofSize = treeSize(pos, proven, seen);
+        return proven ? DFPN_PROVEN : DFPN_DISPROVEN;
+    }
+
+    // can the side to move force a win? when proven, *winningCol (if
+    // given) gets a move that keeps the win
+    DfpnResult solve(const BitPosition &pos, uint64_t nodeLimit = 0, int *winningCol = nullptr) {
+        DfpnResult r = solveFor(pos, pos.toMove, nodeLimit);
+        if (r == DFPN_PROVEN && winningCol) *winningCol = winningMove(pos);
+        return r;
+    }
+
+private:
+    vector<DfpnEntry> table;
+    size_t mask = 0;
+    uint64_t limit = 0;
+    int attacker = 0;
+    bool aborted = false;
+
+    uint64_t entryKey(const BitPosition &pos) const {
+        return pos.key() | (uint64_t(attacker) << 62);
+    }
+
+    static uint64_t mix(uint64_t k) {
+        k ^= k >> 30; k *= 0xBF58476D1CE4E5B9ULL;
+        k ^= k >> 27; k *= 0x94D049BB133111EBULL;
+        k ^= k >> 31;
+        return k;
+    }
+
+    // stored numbers, or the settled ones for a decided position, or 1/1
+    DfpnEntry lookup(const BitPosition &pos) {
+        DfpnEntry e;
+        uint32_t phi, delta;
+        if (terminal(pos, phi, delta)) { e.phi = phi; e.delta = delta; return e; }
+        return probe(pos);
+    }
+
+    // table entry only, 1/1 when absent
+    DfpnEntry probe(const BitPosition &pos) {
+        DfpnEntry e;
+        ++stats.lookups;
+        uint64_t key = entryKey(pos);
+        DfpnEntry *b = &table[(mix(key) & mask) * DFPN_BUCKET_SLOTS];
+        for (int i = 0; i < DFPN_BUCKET_SLOTS; ++i)
+            if (b[i].key == key) { ++stats.hits; return b[i]; }
+        e.key = key;
+        return e;
+    }
+
+    void store(const BitPosition &pos, uint32_t phi, uint32_t delta, uint64_t work) {
+        ++stats.stores;
+        uint64_t key = entryKey(pos);
+        DfpnEntry *b = &table[(mix(key) & mask) * DFPN_BUCKET_SLOTS];
+        DfpnEntry *victim = b;
+        for (int i = 0; i < DFPN_BUCKET_SLOTS; ++i) {
+            if (b[i].key == key || b[i].key == 0) { victim = &b[i]; break; }
+            // settled entries are worth more than any amount of open work
+            auto value = [](const DfpnEntry &x) {
+                return (x.phi == 0 || x.delta == 0) ? ~uint64_t(0) : x.work;
+            };
+            if (value(b[i]) < value(*victim)) victim = &b[i];
+        }
+        if (victim->key != 0 && victim->key != key) ++stats.evictions;
+        victim->key = key;
+        victim->phi = phi;
+        victim->delta = delta;
+        victim->work = work;
+    }
+
+    // positions decided without searching, from the side to move's view:
+    // an immediate win reaches its goal whoever it is (the defender
+    // winning stops the attacker too); a full board is the attacker's
+    // failure; two threats of the opponent can't both be blocked
+    bool terminal(const BitPosition &pos, uint32_t &phi, uint32_t &delta) const {
+        for (int c = 0; c < COLS; ++c)
+            if (pos.canPlay(c) && pos.isWinningMove(c)) { phi = 0; delta = DFPN_INF; return true; }
+        bool attackerToMove = (pos.toMove == attacker);
+        if (pos.isFull()) {
+            phi = attackerToMove ? DFPN_INF : 0;
+            delta = attackerToMove ? 0 : DFPN_INF;
+            return true;
+        }
+        if (threatCount(pos) >= 2) { phi = DFPN_INF; delta = 0; return true; }
+        return false;
+    }
+
+    // columns where the opponent of the side to move would win next
+    static int threatCount(const BitPosition &pos, int *col = nullptr) {
+        int n = 0;
+        for (int c = 0; c < COLS; ++c) {
+            if (!pos.canPlay(c)) continue;
+            if (hasFour(pos.stones[pos.toMove ^ 1] | pos.moveBit(c))) { ++n; if (col) *col = c; }
+        }
+        return n;
+    }
+
+    // legal moves worth trying, center first; a single opponent threat
+    // leaves only the block
+    static int children(const BitPosition &pos, int *cols) {
+        int forced;
+        if (threatCount(pos, &forced) == 1) { cols[0] = forced; return 1; }
+        int n = 0;
+        for (int i = 0; i < COLS; ++i) {
+            int c = COLS / 2 + ((i % 2) ? -(i + 1) / 2 : i / 2);
+            if (pos.canPlay(c)) cols[n++] = c;
+        }
+        return n;
+    }
+
+    static uint32_t add(uint32_t a, uint32_t b) { return min(a + b, DFPN_INF); }
+
+    void mid(const BitPosition &pos, uint32_t thPhi, uint32_t thDelta) {
+        ++stats.nodes;
+        if (limit && stats.nodes > limit) { aborted = true; return; }
+        uint32_t phi, delta;
+        if (terminal(pos, phi, delta)) return;
+        uint64_t nodes0 = stats.nodes;
+
+        // children that are decided outright keep their numbers for the
+        // whole loop; only the open ones are looked up each round
+        int cols[COLS];
+        int n = children(pos, cols);
+        BitPosition kids[COLS];
+        DfpnEntry settled[COLS];
+        bool isSettled[COLS];
+        for (int i = 0; i < n; ++i) {
+            kids[i] = pos;
+            kids[i].play(cols[i]);
+            isSettled[i] = terminal(kids[i], settled[i].phi, settled[i].delta);
+        }
+
+        for (;;) {
+            // phi = min delta(child), delta = sum phi(child)
+            phi = DFPN_INF; delta = 0;
+            int best = -1;
+            uint32_t bestDelta = DFPN_INF, secondDelta = DFPN_INF, bestPhi = 0;
+            for (int i = 0; i < n; ++i) {
+                DfpnEntry e = isSettled[i] ? settled[i] : probe(kids[i]);
+                delta = add(delta, e.phi);
+                if (e.delta < bestDelta) {
+                    secondDelta = bestDelta;
+                    bestDelta = e.delta; bestPhi = e.phi; best = i;
+                } else if (e.delta < secondDelta) {
+                    secondDelta = e.delta;
+                }
+            }
+            phi = bestDelta;
+            if (phi >= thPhi || delta >= thDelta || aborted) break;
+            // search the most promising child until it falls well behind
+            // the runner-up (the 1+epsilon trick: a quarter of slack saves
+            // most of the back-and-forth between close siblings)
+            uint32_t childThPhi = add(thDelta - delta, bestPhi);
+            uint32_t childThDelta = min(thPhi, add(add(secondDelta, secondDelta / 4), 1));
+            mid(kids[best], childThPhi, childThDelta);
+        }
+        store(pos, phi, delta, stats.nodes - nodes0);
+    }
+
+    // a move to a child the attacker still wins from (its delta is 0)
+    int winningMove(const BitPosition &pos) {
+        for (int c = 0; c < COLS; ++c)
+            if (pos.canPlay(c) && pos.isWinningMove(c)) return c;
+        int cols[COLS];
+        int n = children(pos, cols);
+        for (int i = 0; i < n; ++i) {
+            BitPosition kid = pos;
+            kid.play(cols[i]);
+            if (lookup(kid).delta == 0) return cols[i];
+        }
+        return -1;
+    }
+
+    // distinct positions in the proof tree (proven: the attacker's one
+    // winning reply at its nodes, every defence at the defender's) or in
+    // the disproof tree (roles swapped)
+    uint64_t treeSize(const BitPosition &pos, bool proven, unordered_set<uint64_t> &seen) {
+        if (!seen.insert(pos.key()).second) return 0;
+        uint32_t phi, delta;
+        if (terminal(pos, phi, delta)) return 1;
+        DfpnEntry e = lookup(pos);
+        if (e.phi != 0 && e.delta != 0) { stats.proofComplete = false; return 1; }
+
+        int cols[COLS];
+        int n = children(pos, cols);
+        // the side whose goal this tree shows picks one child, the other
+        // side's every move has to be covered
+        bool oneChild = (pos.toMove == attacker) == proven;
+        uint64_t size = 1;
+        for (int i = 0; i < n; ++i) {
+            BitPosition kid = pos;
+            kid.play(cols[i]);
+            if (oneChild) {
+                if (lookup(kid).delta != 0) continue;
+                return size + treeSize(kid, proven, seen);
+            }
+            size += treeSize(kid, proven, seen);
+        }
+        if (oneChild) stats.proofComplete = false;   // winning child evicted
+        return size;
+    }
+};
+
+// won / lost / drawn for the side to move: its own win proven, else the
+// opponent's win proven, else (both disproven) a draw. nodeLimit applies
+// to each of the two solves.
+enum PositionLabel { LABEL_UNKNOWN = 0, LABEL_WIN, LABEL_LOSS, LABEL_DRAW };
+
+inline const char *labelName(PositionLabel l) {
+    switch (l) {
+    case LABEL_WIN:  return "win";
+    case LABEL_LOSS: return "loss";
+    case LABEL_DRAW: return "draw";
+    default:         return "unknown";
+    }
+}
+
+inline PositionLabel labelPosition(DfpnSolver &solver, const BitPosition &pos, uint64_t nodeLimit = 0) {
+    DfpnResult own = solver.solveFor(pos, pos.toMove, nodeLimit);
+    if (own == DFPN_PROVEN) return LABEL_WIN;
+    if (own == DFPN_UNKNOWN) return LABEL_UNKNOWN;
+    DfpnResult other = solver.solveFor(pos, pos.toMove ^ 1, nodeLimit);
+    if (other == DFPN_PROVEN) return LABEL_LOSS;
+    return other == DFPN_DISPROVEN ? LABEL_DRAW : LABEL_UNKNOWN;
+}
+
+// pre-check run by bestMove before its search: with a node budget set, a
+// forced win for the side to move found within it is played at once.
+// off (0) by default. each thread keeps its own solver table.
+struct DfpnPrecheck {
+    uint64_t nodes = 0;
+    size_t tableMB = 4;
+};
+
+inline DfpnPrecheck &dfpnPrecheck() {
+    static DfpnPrecheck settings;
+    return settings;
+}
+
+inline DfpnSolver &dfpnSolver() {
+    static thread_local DfpnSolver solver(dfpnPrecheck().tableMB);
+    return solver;
+}
+
+#endif // PNSEARCH_H
@@ -0,0 +1,213 @@
+// poscache.h
+#ifndef POSCACHE_H
+#define POSCACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include "board.h"
+#include "transposition.h"
+
+// persistent position cache: deeply searched positions kept on disk between
+// runs. the file is a header plus a key-sorted array of fixed-size records,
+// mapped read-only at startup (so loading is near-instant and concurrent
+// processes share the pages) and searched by binary search. results found
+// during the run go to an in-memory table and are merged back into the file
+// on close(), under a lock so parallel runs don't lose each other's work.
+// threads in one process share the cache; only deep nodes touch it, so a
+// mutex around the in-memory part is cheap enough.
+
+const uint32_t POSCACHE_VERSION = 1;
+
+struct PosCacheHeader {
+    char     magic[4];   // "C4PC"
+    uint32_t version;
+    uint32_t rows, cols;
+    uint64_t count;      // number of records that follow
+};
+
+struct PosRecord {
+    uint64_t key;        // Board::key() plus the side-to-move bit
+    int32_t  score;
+    uint8_t  bound;      // TTBound
+    uint8_t  depth;
+    int8_t   move;
+    uint8_t  pad;
+};
+static_assert(sizeof(PosRecord) == 16, "PosRecord must stay 16 bytes");
+
+// deeper wins; at equal depth an exact score beats a bound
+inline bool posRecordBetter(const PosRecord &a, const PosRecord &b) {
+    if (a.depth != b.depth) return a.depth > b.depth;
+    return a.bound == BOUND_EXACT && b.bound != BOUND_EXACT;
+}
+
+class PositionCache {
+public:
+    uint64_t probes = 0, hits = 0;
+
+    ~PositionCache() { close(); }
+
+    // map 'path' if it exists; positions searched to at least minDepth are
+    // recorded for the next run (unless readOnly). returns false on a corrupt
+    // file (or one of another version or board size), and the cache then
+    // stays off so the file is never written over.
+    bool open(const string &filePath, int minDepth = 6, bool readOnly = false) {
+        close();
+        path = filePath;
+        recordDepth = minDepth;
+        noWrites = readOnly;
+        isOpen = mapFile();
+        return isOpen;
+    }
+
+    bool enabled() const { return isOpen; }
+    const string &filePath() const { return path; }
+    int minDepth() const { return recordDepth; }
+    size_t mappedCount() const { return count; }
+    size_t pendingCount() const { return pending.size(); }
+
+    bool probe(uint64_t key, PosRecord &out) {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++probes;
+        auto it = pending.find(key);
+        if (it != pending.end()) { out = it->second; ++hits; return true; }
+        const PosRecord *lo = records, *hi = records + count;
+        const PosRecord *r = lower_bound(lo, hi, key,
+            [](const PosRecord &a, uint64_t k) { return a.key < k; });
+        if (r == hi || r->key != key) return false;
+        out = *r;
+        ++hits;
+        return true;
+    }
+
+    void record(uint64_t key, int score, int depth, int bound, int move) {
+        if (!isOpen || noWrites || depth < recordDepth) return;
+        std::lock_guard<std::mutex> lock(mtx);
+        PosRecord r{key, score, uint8_t(bound), uint8_t(depth), int8_t(move), 0};
+        auto it = pending.find(key);
+        if (it == pending.end() || !posRecordBetter(it->second, r))
+            pending[key] = r;
+    }
+
+    // merge new results into the file (re-read under the lock, in case
+    // another process saved first) and swap it in with an atomic rename
+    bool save() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!isOpen || pending.empty()) return true;
+        int lockFd = ::open((path + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+        if (lockFd < 0) return false;
+        flock(lockFd, LOCK_EX);
+
+        unmapFile();
+        if (!mapFile()) {
+            // replaced by something unreadable since open(); leave it be
+            flock(lockFd, LOCK_UN);
+            ::close(lockFd);
+            return false;
+        }
+        vector<PosRecord> merged(records, records + count);
+        for (auto &kv : pending) merged.push_back(kv.second);
+        sort(merged.begin(), merged.end(), [](const PosRecord &a, const PosRecord &b) {
+            return a.key != b.key ? a.key < b.key : posRecordBetter(a, b);
+        });
+        merged.erase(unique(merged.begin(), merged.end(),
+            [](const PosRecord &a, const PosRecord &b) { return a.key == b.key; }),
+            merged.end());
+
+        bool ok = false;
+        string tmp = path + ".tmp";
+        if (FILE *f = fopen(tmp.c_str(), "wb")) {
+            PosCacheHeader h;
+            memcpy(h.magic, "C4PC", 4);
+            h.version = POSCACHE_VERSION;
+            h.rows = ROWS; h.cols = COLS;
+            h.count = merged.size();
+            ok = fwrite(&h, sizeof h, 1, f) == 1
+              && fwrite(merged.data(), sizeof(PosRecord), merged.size(), f) == merged.size();
+            ok = (fclose(f) == 0) && ok;
+            ok = ok && rename(tmp.c_str(), path.c_str()) == 0;
+        }
+        if (ok) {
+            pending.clear();
+            unmapFile();
+            mapFile();
+        }
+        flock(lockFd, LOCK_UN);
+        ::close(lockFd);
+        return ok;
+    }
+
+    // save and unmap; called automatically at exit
+    void close() {
+        if (!isOpen) return;
+        save();
+        unmapFile();
+        pending.clear();
+        isOpen = false;
+    }
+
+private:
+    string path;
+    int recordDepth = 6;
+    bool isOpen = false;
+    bool noWrites = false;
+    void *base = nullptr;
+    size_t mapBytes = 0;
+    const PosRecord *records = nullptr;
+    size_t count = 0;
+    unordered_map<uint64_t, PosRecord> pending;
+    std::mutex mtx;
+
+    bool mapFile() {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return true;  // no cache yet, first run
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(PosCacheHeader);
+        if (ok) {
+            base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            ok = (base != MAP_FAILED);
+            if (!ok) base = nullptr;
+        }
+        ::close(fd);
+        if (!ok) return false;
+        mapBytes = st.st_size;
+
+        const PosCacheHeader *h = static_cast<const PosCacheHeader *>(base);
+        if (memcmp(h->magic, "C4PC", 4) != 0 || h->version != POSCACHE_VERSION
+            || h->rows != uint32_t(ROWS) || h->cols != uint32_t(COLS)
+            || sizeof(PosCacheHeader) + h->count * sizeof(PosRecord) > mapBytes) {
+            unmapFile();
+            return false;
+        }
+        records = reinterpret_cast<const PosRecord *>(h + 1);
+        count = h->count;
+        return true;
+    }
+
+    void unmapFile() {
+        if (base) munmap(base, mapBytes);
+        base = nullptr;
+        mapBytes = 0;
+        records = nullptr;
+        count = 0;
+    }
+};
+
+// the cache consulted by minMaxAB, disabled until opened
+inline PositionCache &positionCache() {
+    static PositionCache cache;
+    return cache;
+}
+
+#endif // POSCACHE_H
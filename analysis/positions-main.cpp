@@ -0,0 +1,138 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "board.h"
+#include "positions.h"
+#include "pnsearch.h"
+
+// enumerates every distinct position reachable at a given ply (nobody has
+// won yet, the board is not full) and writes them as a position suite.
+//
+//   positions-main --ply N [--out FILE] [--threads N] [--no-mirror]
+//                  [--undecided] [--dfpn NODES] [--sample K] [--seed S]
+//       --no-mirror   keep mirror images as separate positions
+//       --undecided   leave out positions decided at a glance: the side to
+//                     move wins at once, or faces two threats it cannot both block
+//       --dfpn NODES  also leave out positions df-pn proves a win for either
+//                     side within NODES nodes
+//       --sample K    keep a random K of the positions (reproducible with --seed)
+//   positions-main --show FILE [--limit N]
+//       header and the first positions of a suite
+//
+// the enumeration itself is enumeratePositions (positions.h).
+
+using Clock = chrono::steady_clock;
+
+int showSuite(const string &path, size_t limit) {
+    SuiteHeader h;
+    vector<uint64_t> keys;
+    if (!readSuite(path, h, keys)) {
+        cerr << "cannot read " << path << " (is it a " << ROWS << "x" << COLS << " suite?)" << endl;
+        return 1;
+    }
+    cout << path << ": " << h.count << " positions at ply " << h.ply
+         << (h.flags & SUITE_MIRROR ? ", mirrors merged" : "")
+         << (h.flags & SUITE_UNDECIDED ? ", undecided only" : "")
+         << (h.flags & SUITE_DFPN ? ", df-pn filtered" : "")
+         << (h.flags & SUITE_SAMPLED ? ", sampled" : "") << "\n";
+    for (size_t i = 0; i < keys.size() && i < limit; ++i) {
+        BitPosition pos = positionFromKey(keys[i]);
+        cout << "\n#" << i << ", " << playerToMove(pos) << " to move\n";
+        Board board = boardFromPosition(pos);
+        for (const auto &row : board.grid) {
+            for (char cell : row) cout << cell << ' ';
+            cout << '\n';
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int ply = -1, threads = int(thread::hardware_concurrency());
+    bool mirror = true, undecided = false;
+    uint64_t dfpnNodes = 0;
+    size_t sample = 0, limit = 3;
+    unsigned seed = 1;
+    string outPath, showPath;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool more = i + 1 < argc;
+        if (arg == "--ply" && more)            ply = atoi(argv[++i]);
+        else if (arg == "--out" && more)       outPath = argv[++i];
+        else if (arg == "--threads" && more)   threads = atoi(argv[++i]);
+        else if (arg == "--no-mirror")         mirror = false;
+        else if (arg == "--undecided")         undecided = true;
+        else if (arg == "--dfpn" && more)      dfpnNodes = atoll(argv[++i]);
+        else if (arg == "--sample" && more)    sample = atol(argv[++i]);
+        else if (arg == "--seed" && more)      seed = unsigned(atol(argv[++i]));
+        else if (arg == "--show" && more)      showPath = argv[++i];
+        else if (arg == "--limit" && more)     limit = atol(argv[++i]);
+        else {
+            cerr << "Usage: " << argv[0] << " --ply N [--out FILE] [--threads N] [--no-mirror]"
+                 << " [--undecided] [--dfpn NODES] [--sample K] [--seed S]\n"
+                 << "       " << argv[0] << " --show FILE [--limit N]" << endl;
+            return 1;
+        }
+    }
+    if (!showPath.empty()) return showSuite(showPath, limit);
+    if (ply < 0 || ply >= ROWS * COLS) { cerr << "need --ply between 0 and " << ROWS * COLS - 1 << endl; return 1; }
+    if (threads < 1) threads = 1;
+    if (outPath.empty()) outPath = "positions-" + to_string(ply) + ".bin";
+
+    auto t0 = Clock::now();
+    cout << setw(6) << "ply" << setw(14) << "positions" << "\n";
+    vector<uint64_t> level = enumeratePositions(ply, threads, mirror,
+        [](int p, const vector<uint64_t> &keys) { cout << setw(6) << p << setw(14) << keys.size() << "\n"; });
+    double enumSecs = chrono::duration<double>(Clock::now() - t0).count();
+
+    uint32_t flags = mirror ? uint32_t(SUITE_MIRROR) : 0;
+    size_t enumerated = level.size();
+    if (undecided || dfpnNodes) {
+        // filter in parallel, keep the order
+        vector<char> drop(level.size(), 0);
+        atomic<size_t> proven{0};
+        vector<unique_ptr<DfpnSolver>> solvers(threads);
+        parallelFor(threads, level.size(), [&](int id, size_t from, size_t to) {
+            if (dfpnNodes && !solvers[id]) solvers[id].reset(new DfpnSolver(16));
+            for (size_t i = from; i < to; ++i) {
+                BitPosition pos = positionFromKey(level[i]);
+                if (undecided && decidedAtAGlance(pos)) { drop[i] = 1; continue; }
+                if (dfpnNodes) {
+                    PositionLabel l = labelPosition(*solvers[id], pos, dfpnNodes);
+                    if (l == LABEL_WIN || l == LABEL_LOSS) { drop[i] = 1; ++proven; }
+                }
+            }
+        });
+        size_t kept = 0;
+        for (size_t i = 0; i < level.size(); ++i)
+            if (!drop[i]) level[kept++] = level[i];
+        level.resize(kept);
+        if (undecided) flags |= SUITE_UNDECIDED;
+        if (dfpnNodes) flags |= SUITE_DFPN;
+        cout << "filtered: " << enumerated - kept << " decided"
+             << (dfpnNodes ? " (" + to_string(proven.load()) + " by df-pn)" : string()) << ", "
+             << kept << " left\n";
+    }
+    if (sample && sample < level.size()) {
+        mt19937_64 rng(seed);
+        shuffle(level.begin(), level.end(), rng);
+        level.resize(sample);
+        sort(level.begin(), level.end());
+        flags |= SUITE_SAMPLED;
+        cout << "sampled " << sample << " (seed " << seed << ")\n";
+    }
+    if (!writeSuite(outPath, ply, flags, level)) { cerr << "could not write " << outPath << endl; return 1; }
+    cout << "wrote " << level.size() << " positions to " << outPath << " ("
+         << sizeof(SuiteHeader) + level.size() * sizeof(uint64_t) << " bytes), enumerated in "
+         << fixed << setprecision(2) << enumSecs << " s on " << threads << " threads\n";
+    return 0;
+}
@@ -0,0 +1,168 @@
+// positions.h
+#ifndef POSITIONS_H
+#define POSITIONS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "board.h"
+
+// position suite files (written by positions-main): distinct start
+// positions for benchmarks, matches and book building. a 32-byte header,
+// then the positions' keys (BitPosition::key()) sorted ascending, 8 bytes
+// each; with SUITE_MIRROR a position and its mirror image share one entry,
+// the smaller of the two keys. a key holds the whole position and the side
+// to move follows from the piece count, so nothing else is stored.
+
+const uint32_t SUITE_VERSION = 1;
+
+enum SuiteFlags : uint32_t {
+    SUITE_MIRROR     = 1,   // mirror images deduplicated
+    SUITE_UNDECIDED  = 2,   // positions decided at a glance left out
+    SUITE_DFPN       = 4,   // positions df-pn could prove left out
+    SUITE_SAMPLED    = 8,   // a random subset of the enumeration
+};
+
+struct SuiteHeader {
+    char     magic[4];   // "C4PS"
+    uint32_t version;
+    uint32_t rows, cols;
+    uint32_t ply;
+    uint32_t flags;
+    uint64_t count;
+};
+
+inline bool writeSuite(const string &path, uint32_t ply, uint32_t flags, const vector<uint64_t> &keys) {
+    SuiteHeader h;
+    memcpy(h.magic, "C4PS", 4);
+    h.version = SUITE_VERSION;
+    h.rows = ROWS;
+    h.cols = COLS;
+    h.ply = ply;
+    h.flags = flags;
+    h.count = keys.size();
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(&h, sizeof h, 1, f) == 1
+           && (keys.empty() || fwrite(keys.data(), sizeof(uint64_t), keys.size(), f) == keys.size());
+    return (fclose(f) == 0) && ok;
+}
+
+// false if the file is missing, damaged or for another board size
+inline bool readSuite(const string &path, SuiteHeader &h, vector<uint64_t> &keys) {
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    bool ok = fread(&h, sizeof h, 1, f) == 1 && memcmp(h.magic, "C4PS", 4) == 0
+           && h.version == SUITE_VERSION && h.rows == uint32_t(ROWS) && h.cols == uint32_t(COLS);
+    if (ok) {
+        keys.resize(h.count);
+        ok = h.count == 0 || fread(keys.data(), sizeof(uint64_t), keys.size(), f) == keys.size();
+    }
+    fclose(f);
+    return ok;
+}
+
+// every thread runs fn(thread, from, to) on slices of [0, n)
+template <class Fn>
+void parallelFor(int threads, size_t n, Fn fn) {
+    atomic<size_t> next{0};
+    const size_t chunk = 4096;
+    auto worker = [&](int id) {
+        for (size_t start; (start = next.fetch_add(chunk)) < n; )
+            fn(id, start, min(n, start + chunk));
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto &t : pool) t.join();
+}
+
+// sorted, duplicate-free union of sorted buffers
+inline vector<uint64_t> mergeUnique(vector<vector<uint64_t>> &bufs) {
+    size_t total = 0;
+    for (auto &b : bufs) total += b.size();
+    vector<uint64_t> out;
+    out.reserve(total);
+    typedef pair<uint64_t, size_t> Head;
+    priority_queue<Head, vector<Head>, greater<Head>> heads;
+    vector<size_t> pos(bufs.size(), 0);
+    for (size_t i = 0; i < bufs.size(); ++i)
+        if (!bufs[i].empty()) heads.push({bufs[i][0], i});
+    while (!heads.empty()) {
+        Head h = heads.top();
+        heads.pop();
+        if (out.empty() || out.back() != h.first) out.push_back(h.first);
+        if (++pos[h.second] < bufs[h.second].size()) heads.push({bufs[h.second][pos[h.second]], h.second});
+    }
+    for (auto &b : bufs) vector<uint64_t>().swap(b);
+    return out;
+}
+
+// every distinct position after 'ply' moves from the empty board in which
+// nobody has won and the board is not full, as sorted keys; with 'mirror'
+// a position and its mirror image share the smaller key. the walk goes ply
+// by ply: threads expand slices of one ply's positions into their own
+// buffers, sort and dedupe them, and the buffers are merged into the next
+// ply, so each distinct position is expanded only once. onLevel(p, keys)
+// sees every ply on the way, 0 included.
+template <class OnLevel>
+vector<uint64_t> enumeratePositions(int ply, int threads, bool mirror, OnLevel onLevel) {
+    if (threads < 1) threads = 1;
+    auto canon = [mirror](uint64_t key) { return mirror ? canonicalKey(key) : key; };
+    vector<uint64_t> level = {BitPosition().key()};
+    onLevel(0, level);
+    for (int p = 1; p <= ply; ++p) {
+        vector<vector<uint64_t>> bufs(threads);
+        parallelFor(threads, level.size(), [&](int id, size_t from, size_t to) {
+            vector<uint64_t> &buf = bufs[id];
+            for (size_t i = from; i < to; ++i) {
+                BitPosition pos = positionFromKey(level[i]);
+                for (int c = 0; c < COLS; ++c) {
+                    if (!pos.canPlay(c) || pos.isWinningMove(c)) continue;
+                    BitPosition next = pos;
+                    next.play(c);
+                    if (!next.isFull()) buf.push_back(canon(next.key()));
+                }
+            }
+        });
+        parallelFor(threads, bufs.size(), [&](int, size_t from, size_t to) {
+            for (size_t b = from; b < to; ++b) {
+                sort(bufs[b].begin(), bufs[b].end());
+                bufs[b].erase(unique(bufs[b].begin(), bufs[b].end()), bufs[b].end());
+            }
+        });
+        level = mergeUnique(bufs);
+        onLevel(p, level);
+    }
+    return level;
+}
+
+inline vector<uint64_t> enumeratePositions(int ply, int threads = 1, bool mirror = false) {
+    return enumeratePositions(ply, threads, mirror, [](int, const vector<uint64_t> &) {});
+}
+
+// the side to move wins at once, or the opponent has two immediate wins
+inline bool decidedAtAGlance(const BitPosition &pos) {
+    BitPosition other = pos;
+    other.toMove ^= 1;
+    int threats = 0;
+    for (int c = 0; c < COLS; ++c) {
+        if (!pos.canPlay(c)) continue;
+        if (pos.isWinningMove(c)) return true;
+        threats += other.isWinningMove(c);
+    }
+    return threats >= 2;
+}
+
+// MAX_PLAYER or MIN_PLAYER, whoever is to move in 'pos'
+inline char playerToMove(const BitPosition &pos) {
+    return pos.toMove == 0 ? MAX_PLAYER : MIN_PLAYER;
+}
+
+#endif // POSITIONS_H
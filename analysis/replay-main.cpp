@@ -0,0 +1,210 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include "instrumentation.h"
+#include "board.h"
+#include "engine.h"
+#include "multipv.h"
+#include "watchdog.h"
+#include "trace.h"
+// globals
+thread_local uint64_t g_nodesGenerated = 0;
+thread_local uint64_t g_nodesExpanded  = 0;
+
+// replays searches captured by the slow-search watchdog (watchdog.h, the
+// --slow-log option of analysis-main and engine-main).
+//
+//   replay-main LOG [--list] [--case N] [--repeat R] [--tt-mb N]
+//               [--perf] [--trace FILE]
+//       --list       the captured cases, one per line
+//       --case N     replay only case N (counting from 0, comments skipped)
+//       --repeat R   run each case R times and report the fastest and median
+//       --tt-mb N    table size for cases logged without one (default 16)
+//       --perf       hardware counters per run
+//       --trace FILE chrome trace-event timeline of the runs
+//
+// each case is set up with the process-wide settings it was captured
+// with (df-pn precheck, table size, book, tablebase, and the position
+// cache read-only), and each run starts from empty tables and searches the
+// way the captured one did: one fixed-depth bestMove, or iterative deepening (multi-PV when it
+// scored several root moves) under the same node budget. a search that ran
+// against the clock or was stopped gets the nodes it used live as its
+// budget instead, which is deterministic, so every run is the same search
+// (same nodes, same move) ready to time under perf or a profiler. a search
+// captured with warm tables (a later move of a game) takes a different
+// path from empty ones, so its node count and move can differ from the
+// capture, and so can one whose cache file has grown since; compare
+// replays with replays. mcts cases with a time budget or
+// several threads do not repeat exactly, and stopped ones replay in full.
+
+using Clock = chrono::steady_clock;
+
+struct RunResult {
+    double ms;
+    uint64_t nodes;
+    Move mv;
+    int score;
+    PerfSample perf;
+};
+
+// the process-wide settings of the capture; false if a file it used is gone
+bool applyCaseSettings(const SlowCase &c) {
+    dfpnPrecheck().nodes = c.dfpnNodes;
+    dfpnPrecheck().tableMB = c.dfpnMB;
+    if (c.book.empty()) openingBook().close();
+    else if (!openingBook().open(c.book)) return false;
+    if (c.tablebase.empty()) tablebase().close();
+    else if (!tablebase().open(c.tablebase)) return false;
+    if (c.cache.empty()) positionCache().close();
+    else if (!positionCache().open(c.cache, 6, true)) return false;
+    return true;
+}
+
+RunResult runCase(const SlowCase &c, const EngineSettings &settings, Board board, size_t ttMB, bool perf) {
+    transpositionTable().resize(c.ttMB >= 0 ? size_t(c.ttMB) : ttMB);
+    evalCache().clear();
+    dfpnSolver().resize(dfpnPrecheck().tableMB);
+    threatCounters() = ThreatCounters();
+    RunResult r{0, 0, Move{-1, -1}, 0, PerfSample()};
+    PerfSample before;
+    if (perf) before = perfCounters().read();
+    uint64_t n0 = g_nodesGenerated;
+    auto t0 = Clock::now();
+    {
+        TraceSpan span("replay", "replay");
+        span.arg("nodes-captured", int64_t(c.nodes));
+        if (settings.kind == ENGINE_MCTS) {
+            r.mv = mctsBestMove(board, c.player, settings.mcts);
+        } else if (c.iterative) {
+            threatSearch().nodes = settings.threats;
+            SearchLimits limits;
+            limits.depth = settings.depth;
+            if (c.stopped || (!c.nodeLimit && settings.timeMs > 0)) limits.nodes = c.nodes;
+            else if (c.nodeLimit > 0)                               limits.nodes = c.nodeLimit;
+            if (c.multiPV > 1) {
+                vector<RootLine> lines = multiPV(board, c.player, limits, c.multiPV, settings.eval);
+                if (!lines.empty()) {
+                    r.mv.col = lines[0].col;
+                    r.score = lines[0].score;
+                }
+            } else {
+                r.mv = bestMoveWithin(board, c.player, limits, settings.eval, nullptr, &r.score);
+            }
+        } else {
+            threatSearch().nodes = settings.threats;
+            r.mv = bestMove(board, settings.depth, c.player, settings.eval, &r.score);
+        }
+    }
+    r.ms = chrono::duration<double, milli>(Clock::now() - t0).count();
+    r.nodes = g_nodesGenerated - n0;
+    if (perf) r.perf = perfDelta(before, perfCounters().read());
+    return r;
+}
+
+int main(int argc, char* argv[]) {
+    string logPath, tracePath;
+    bool list = false, perf = false;
+    int only = -1, repeat = 1;
+    size_t ttMB = 16;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool more = i + 1 < argc;
+        if (arg == "--list")                  list = true;
+        else if (arg == "--case" && more)     only = atoi(argv[++i]);
+        else if (arg == "--repeat" && more)   repeat = atoi(argv[++i]);
+        else if (arg == "--tt-mb" && more)    ttMB = atol(argv[++i]);
+        else if (arg == "--perf")             perf = true;
+        else if (arg == "--trace" && more)    tracePath = argv[++i];
+        else if (logPath.empty() && arg[0] != '-') logPath = arg;
+        else { logPath.clear(); break; }
+    }
+    if (logPath.empty()) {
+        cerr << "Usage: " << argv[0] << " LOG [--list] [--case N] [--repeat R] [--tt-mb N]"
+             << " [--perf] [--trace FILE]" << endl;
+        return 1;
+    }
+    ifstream in(logPath);
+    if (!in) { cerr << "cannot read " << logPath << endl; return 1; }
+    vector<SlowCase> cases;
+    string line;
+    SlowCase c;
+    while (getline(in, line))
+        if (parseSlowCase(line, c)) cases.push_back(c);
+    if (cases.empty()) { cerr << "no cases in " << logPath << endl; return 1; }
+    if (only >= int(cases.size())) { cerr << "only " << cases.size() << " cases" << endl; return 1; }
+
+    cout << fixed << setprecision(1);
+    if (list) {
+        for (size_t i = 0; i < cases.size(); ++i)
+            cout << setw(4) << i << setw(10) << cases[i].ms << " ms" << setw(12) << cases[i].nodes
+                 << " nodes  " << cases[i].player << " to move after " << (cases[i].moves.empty() ? "-" : cases[i].moves)
+                 << "  " << cases[i].spec << "\n";
+        return 0;
+    }
+    if (repeat < 1) repeat = 1;
+    if (perf && !perfCounters().open())
+        cerr << "hardware counters unavailable, perf columns will read n/a" << endl;
+    if (!tracePath.empty()) traceRecorder().start(tracePath);
+
+    int failures = 0;
+    for (size_t i = 0; i < cases.size(); ++i) {
+        if (only >= 0 && int(i) != only) continue;
+        const SlowCase &sc = cases[i];
+        EngineSettings settings;
+        Board board;
+        char toMove;
+        if (!parseEngineSpec(sc.spec, settings) || !playMoves(sc.moves, board, toMove)
+            || !applyCaseSettings(sc)) {
+            cout << "case " << i << ": cannot set up (moves " << sc.moves << ", spec " << sc.spec
+                 << ", or a book, cache or tablebase file it used is unreadable)\n";
+            ++failures;
+            continue;
+        }
+        cout << "case " << i << ": " << sc.player << " to move after "
+             << (sc.moves.empty() ? "-" : sc.moves) << ", " << sc.spec
+             << (sc.multiPV > 1 ? ", multipv " + to_string(sc.multiPV) : string())
+             << (sc.reached ? ", depth " + to_string(sc.reached) : string())
+             << (sc.stopped ? ", stopped" : "") << "\n"
+             << "  captured  " << setw(10) << sc.ms << " ms" << setw(12) << sc.nodes << " nodes"
+             << "  col " << sc.col << " score " << sc.score << "\n";
+
+        vector<RunResult> runs;
+        for (int r = 0; r < repeat; ++r) runs.push_back(runCase(sc, settings, board, ttMB, perf));
+        vector<double> times;
+        for (const RunResult &r : runs) times.push_back(r.ms);
+        sort(times.begin(), times.end());
+        const RunResult &first = runs[0];
+        bool stable = all_of(runs.begin(), runs.end(), [&](const RunResult &r) {
+            return r.nodes == first.nodes && r.mv.col == first.mv.col;
+        });
+        cout << "  replayed  " << setw(10) << times[0] << " ms" << setw(12) << first.nodes << " nodes"
+             << "  col " << first.mv.col << " score " << first.score;
+        if (repeat > 1) cout << "  (median " << times[times.size() / 2] << " ms over " << repeat << " runs)";
+        cout << "\n";
+        if (first.mv.col != sc.col)
+            cout << "  note: replay picked col " << first.mv.col << ", the capture col " << sc.col << "\n";
+        if (!stable) {
+            cout << "  note: runs differ in nodes or move (mcts, or a nondeterministic search)\n";
+            if (settings.kind != ENGINE_MCTS) ++failures;
+        }
+        if (perf) {
+            const PerfSample &p = first.perf;
+            if (p.valid)
+                cout << "  perf      cycles " << p.cycles << " instr " << p.instructions
+                     << " ipc " << setprecision(2) << p.ipc() << setprecision(1)
+                     << " l1dMiss " << p.l1dMisses << " llcMiss " << p.llcMisses
+                     << " brMiss " << p.branchMisses << "\n";
+            else
+                cout << "  perf      n/a\n";
+        }
+    }
+    if (!tracePath.empty() && !traceRecorder().flush())
+        cerr << "could not write trace " << tracePath << endl;
+    return failures ? 1 : 0;
+}
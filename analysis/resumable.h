@@ -0,0 +1,213 @@
+// resumable.h
+#ifndef RESUMABLE_H
+#define RESUMABLE_H
+
+#include <cstdint>
+#include <vector>
+#include <limits>
+#include <chrono>
+#include "board.h"
+#include "instrumentation.h"
+#include "hueristics.h"
+
+// bestMoveWithin as a resumable task. the recursion of minMaxAB is kept on
+// an explicit stack of frames, so step() can run the search for a number of
+// nodes, return, and carry on from the same node on the next call (on any
+// thread). iterative deepening and the deadline are handled the same way:
+// depth 1 always finishes, deeper iterations run until the deadline and an
+// unfinished one is thrown away.
+//
+// the node rules are minMaxAB's (leaf test, evaluation cache, threat search
+// at the horizon, table cutoffs and stores, move ordering), and the root is
+// bestMove's (every column with a full window, first best wins), so a
+// search that runs to completion returns what bestMove would with the same
+// tables. the persistent position cache is not consulted.
+class ResumableSearch {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    ResumableSearch() {}
+    ResumableSearch(const Board &board, char player, int maxDepth, EvalKind evalKind,
+                    Clock::time_point deadline = Clock::time_point::max())
+        : board(board), rootMax(player == MAX_PLAYER), maxDepth(maxDepth),
+          evalKind(evalKind), deadline(deadline) {}
+
+    // run for about 'nodes' nodes (or until done); true once finished
+    bool step(uint64_t nodes) {
+        if (finished) return true;
+        uint64_t end = g_nodesGenerated + nodes;
+        while (g_nodesGenerated < end) {
+            if (stack.empty()) {
+                // between iterations: keep going while there is time
+                if (depth >= maxDepth || (depth >= 1 && Clock::now() >= deadline)) {
+                    finished = true;
+                    return true;
+                }
+                startIteration(depth + 1);
+                continue;
+            }
+            if (depth >= 1 && (g_nodesGenerated & 1023) == 0 && Clock::now() >= deadline) {
+                abandonIteration();
+                finished = true;
+                return true;
+            }
+            advance();
+        }
+        return finished;
+    }
+
+    bool done() const { return finished; }
+    Move move() const { return Move{-1, bestCol}; }
+    int score() const { return bestScore; }
+    int depthReached() const { return depth; }
+    uint64_t nodes() const { return nodeCount; }
+
+private:
+    struct Frame {
+        int depth, alpha, beta, alphaOrig, betaOrig;
+        int result, bestCol;
+        int next;       // next index for orderedColumn
+        int col;        // column being searched below, -1 between children
+        int ttMove;
+        uint64_t key;
+        bool isMax, root;
+    };
+
+    Board board;
+    bool rootMax = true;
+    int maxDepth = 1;
+    EvalKind evalKind = EVAL_BY_SIDE;
+    Clock::time_point deadline;
+
+    std::vector<Frame> stack;
+    int depth = 0;                   // last finished iteration
+    int bestCol = -1, bestScore = 0;
+    uint64_t nodeCount = 0;
+    bool finished = false;
+
+    static char side(bool isMax) { return isMax ? MAX_PLAYER : MIN_PLAYER; }
+
+    // 'resolve': an unfinished game at the horizon, for the threat search
+    template <class Eval>
+    int leafValue(bool isMax, bool resolve) {
+        if (!resolve) return isMax ? cachedEvaluate<true, Eval>(board) : cachedEvaluate<false, Eval>(board);
+        return isMax ? horizonValue<true, Eval>(board) : horizonValue<false, Eval>(board);
+    }
+
+    int leafValue(bool isMax, bool resolve) {
+        switch (evalKind) {
+        case EVAL_CENTER: return leafValue<CenterBiasEval>(isMax, resolve);
+        case EVAL_SPARSE: return leafValue<SparseBiasEval>(isMax, resolve);
+        case EVAL_TUNED:  return leafValue<TunedEval>(isMax, resolve);
+        default:          return leafValue<BySideEval>(isMax, resolve);
+        }
+    }
+
+    void startIteration(int d) {
+        transpositionTable().newSearch();
+        Frame root = frame(d, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), rootMax);
+        root.root = true;
+        root.key = 0;
+        stack.push_back(root);
+    }
+
+    // unwind an unfinished iteration, putting the board back
+    void abandonIteration() {
+        for (; !stack.empty(); stack.pop_back())
+            if (stack.back().col >= 0) board.undoMove(stack.back().col);
+    }
+
+    Frame frame(int d, int alpha, int beta, bool isMax) const {
+        Frame f;
+        f.depth = d;
+        f.alpha = f.alphaOrig = alpha;
+        f.beta = f.betaOrig = beta;
+        f.result = isMax ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max();
+        f.bestCol = -1;
+        f.next = 0;
+        f.col = -1;
+        f.ttMove = -1;
+        f.isMax = isMax;
+        f.root = false;
+        return f;
+    }
+
+    // one step of the top frame: start its next child, or finish it
+    void advance() {
+        Frame &f = stack.back();
+        int c = -1;
+        while (f.next < COLS && f.beta > f.alpha) {
+            int cand = orderedColumn(f.next++, f.ttMove);
+            if (board.isValidMove(cand)) { c = cand; break; }
+        }
+        if (c < 0) { finishFrame(); return; }
+
+        board.makeMove(c, side(f.isMax));
+        f.col = c;
+        // the root gives every column a full window, as bestMove does
+        int alpha = f.root ? std::numeric_limits<int>::min() : f.alpha;
+        int beta  = f.root ? std::numeric_limits<int>::max() : f.beta;
+        enter(f.depth - 1, alpha, beta, !f.isMax);
+    }
+
+    // minMaxAB's entry: a leaf or a table cutoff answers at once,
+    // anything else gets a frame
+    void enter(int d, int alpha, int beta, bool isMax) {
+        bool isLeaf = (d == 0) || board.checkWin(MAX_PLAYER)
+                      || board.checkWin(MIN_PLAYER) || board.isFull();
+        noteNode(isLeaf);
+        ++nodeCount;
+        if (isLeaf) {
+            bool resolve = d == 0 && threatSearch().nodes && !board.checkWin(MAX_PLAYER)
+                        && !board.checkWin(MIN_PLAYER) && !board.isFull();
+            deliver(leafValue(isMax, resolve));
+            return;
+        }
+
+        Frame f = frame(d, alpha, beta, isMax);
+        f.key = searchKey(board, side(isMax), evalKind);
+        TranspositionTable &tt = transpositionTable();
+        if (tt.enabled()) {
+            TTEntry e;
+            if (tt.probe(f.key, e)) {
+                if (e.depth >= d) {
+                    if (e.bound == BOUND_EXACT) { deliver(e.score); return; }
+                    if (e.bound == BOUND_LOWER && e.score >= beta) { deliver(e.score); return; }
+                    if (e.bound == BOUND_UPPER && e.score <= alpha) { deliver(e.score); return; }
+                }
+                f.ttMove = e.move;
+            }
+        }
+        stack.push_back(f);
+    }
+
+    void finishFrame() {
+        Frame f = stack.back();
+        stack.pop_back();
+        if (f.root) {
+            depth = f.depth;
+            bestCol = f.bestCol;
+            bestScore = f.result;
+            return;
+        }
+        TTBound bound = (f.result <= f.alphaOrig) ? BOUND_UPPER
+                      : (f.result >= f.betaOrig)  ? BOUND_LOWER
+                                                  : BOUND_EXACT;
+        TranspositionTable &tt = transpositionTable();
+        if (tt.enabled()) tt.store(f.key, f.result, f.depth, bound, f.bestCol);
+        deliver(f.result);
+    }
+
+    // hand a child's value to the frame that is waiting for it
+    void deliver(int value) {
+        Frame &f = stack.back();
+        board.undoMove(f.col);
+        if (f.isMax ? value > f.result : value < f.result) { f.result = value; f.bestCol = f.col; }
+        f.col = -1;
+        if (f.root) return;
+        if (f.isMax) f.alpha = std::max(f.alpha, value);
+        else         f.beta  = std::min(f.beta, value);
+    }
+};
+
+#endif // RESUMABLE_H
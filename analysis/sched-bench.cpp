@@ -0,0 +1,285 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include "instrumentation.h"
+#include "board.h"
+#include "engine.h"
+#include "scheduler.h"
+// globals
+thread_local uint64_t g_nodesGenerated = 0;
+thread_local uint64_t g_nodesExpanded  = 0;
+
+// load test for SearchScheduler: hundreds of concurrent games, each asking
+// for a move, "thinking" for a random while after the answer, and asking
+// again. games get different move timers (--budgets), so some are always
+// close to their deadline. the same load runs three ways:
+//   deadline-first   the scheduler as used by a server
+//   round-robin      the same pool, slices in plain submission order
+//   thread per game  one blocking bestMoveWithin thread per game
+// and each is reported as per-move latency percentiles (request to answer),
+// the share of moves answered late and the mean depth reached. all three
+// use one shared transposition table of --tt-mb.
+//
+// before the load, a few positions are searched with ResumableSearch in
+// small slices and with bestMoveWithin, to check they agree move for move.
+
+using Clock = chrono::steady_clock;
+
+struct Options {
+    int games = 300, moves = 6, threads = int(thread::hardware_concurrency());
+    int depth = 10;
+    uint64_t quantum = 2000;
+    vector<double> budgets = {20, 50, 200};
+    double thinkMs = 50;
+    size_t ttMB = 64;
+    EvalKind eval = EVAL_BY_SIDE;
+};
+
+struct MoveSample {
+    double latencyMs;
+    double budgetMs;
+    int depth;
+};
+
+struct GameSim {
+    Board board;
+    char player = MAX_PLAYER;
+    double budgetMs = 0;
+    int asked = 0;
+    uint64_t rng = 0;
+
+    double thinkMs(double maxMs) {
+        rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+        return maxMs * double(rng % 1000) / 1000.0;
+    }
+
+    // apply an answer; a finished game starts over
+    void play(int col) {
+        if (col >= 0 && board.isValidMove(col)) {
+            board.makeMove(col, player);
+            bool over = board.checkWin(player) || board.isFull();
+            player = (player == MAX_PLAYER) ? MIN_PLAYER : MAX_PLAYER;
+            if (!over) return;
+        }
+        board = Board();
+        player = MAX_PLAYER;
+    }
+};
+
+vector<GameSim> makeGames(const Options &opt) {
+    vector<GameSim> games(opt.games);
+    for (int g = 0; g < opt.games; ++g) {
+        games[g].budgetMs = opt.budgets[g % opt.budgets.size()];
+        games[g].rng = 0x9E3779B97F4A7C15ULL * (g + 1);
+        // a couple of opening moves so the games are not all alike
+        games[g].play(g % COLS);
+        games[g].play((g / COLS) % COLS);
+    }
+    return games;
+}
+
+// the load on the scheduler: a driver thread issues requests as games
+// finish thinking, answers come back on the pool threads
+vector<MoveSample> runScheduled(const Options &opt, bool deadlineFirst, SharedTranspositionTable &tt) {
+    vector<GameSim> games = makeGames(opt);
+    vector<MoveSample> samples;
+    typedef pair<Clock::time_point, int> Wake;
+    priority_queue<Wake, vector<Wake>, greater<Wake>> wakes;
+    mutex mtx;
+    condition_variable cv;
+    int finished = 0;
+
+    auto start = Clock::now();
+    for (int g = 0; g < opt.games; ++g)
+        wakes.push({start + chrono::microseconds(int64_t(games[g].thinkMs(opt.thinkMs) * 1000)), g});
+    {
+        SearchScheduler scheduler(opt.threads, opt.quantum, 0, &tt, deadlineFirst);
+        unique_lock<mutex> lock(mtx);
+        while (finished < opt.games) {
+            if (wakes.empty()) { cv.wait(lock); continue; }
+            if (Clock::now() < wakes.top().first) {
+                cv.wait_until(lock, wakes.top().first);
+                continue;
+            }
+            int g = wakes.top().second;
+            wakes.pop();
+            GameSim &game = games[g];
+            Clock::time_point asked = Clock::now();
+            Clock::time_point deadline = asked + chrono::microseconds(int64_t(game.budgetMs * 1000));
+            ResumableSearch search(game.board, game.player, opt.depth, opt.eval, deadline);
+            scheduler.submit(search, deadline, [&, g, asked](ResumableSearch &s) {
+                double ms = chrono::duration<double, milli>(Clock::now() - asked).count();
+                lock_guard<mutex> l(mtx);
+                GameSim &gs = games[g];
+                samples.push_back({ms, gs.budgetMs, s.depthReached()});
+                gs.play(s.move().col);
+                if (++gs.asked >= opt.moves) ++finished;
+                else wakes.push({Clock::now() + chrono::microseconds(int64_t(gs.thinkMs(opt.thinkMs) * 1000)), g});
+                cv.notify_one();
+            });
+        }
+    }
+    return samples;
+}
+
+// the same load with a blocking search thread per game
+vector<MoveSample> runThreadPerGame(const Options &opt, SharedTranspositionTable &tt) {
+    vector<GameSim> games = makeGames(opt);
+    vector<MoveSample> samples;
+    mutex mtx;
+    vector<thread> threads;
+    for (int g = 0; g < opt.games; ++g)
+        threads.emplace_back([&, g] {
+            transpositionTable().attach(&tt);
+            GameSim &game = games[g];
+            for (int m = 0; m < opt.moves; ++m) {
+                this_thread::sleep_for(chrono::duration<double, milli>(game.thinkMs(opt.thinkMs)));
+                auto asked = Clock::now();
+                SearchLimits limits;
+                limits.depth = opt.depth;
+                limits.timeMs = game.budgetMs;
+                int reached = 0;
+                Move mv = bestMoveWithin(game.board, game.player, limits, opt.eval, &reached);
+                double ms = chrono::duration<double, milli>(Clock::now() - asked).count();
+                game.play(mv.col);
+                lock_guard<mutex> lock(mtx);
+                samples.push_back({ms, game.budgetMs, reached});
+            }
+        });
+    for (auto &t : threads) t.join();
+    return samples;
+}
+
+double percentile(vector<double> v, double p) {
+    if (v.empty()) return 0;
+    sort(v.begin(), v.end());
+    size_t i = size_t(p * (v.size() - 1) + 0.5);
+    return v[min(i, v.size() - 1)];
+}
+
+void report(const string &name, const vector<MoveSample> &samples, const vector<double> &budgets) {
+    auto row = [&](const string &label, double budget) {
+        vector<double> lat;
+        size_t late = 0;
+        double depthSum = 0;
+        for (const MoveSample &s : samples) {
+            if (budget > 0 && s.budgetMs != budget) continue;
+            lat.push_back(s.latencyMs);
+            // a few ms over the timer counts as on time
+            late += s.latencyMs > s.budgetMs + 5;
+            depthSum += s.depth;
+        }
+        cout << setw(18) << label << setw(8) << lat.size()
+             << setw(10) << percentile(lat, 0.50) << setw(10) << percentile(lat, 0.95)
+             << setw(10) << percentile(lat, 0.99) << setw(10) << percentile(lat, 1.0)
+             << setw(9) << (lat.empty() ? 0.0 : 100.0 * late / lat.size())
+             << (lat.empty() ? 0.0 : depthSum / lat.size()) << "\n";
+    };
+    row(name, 0);
+    for (double b : budgets) {
+        stringstream label;
+        label << "  " << b << " ms timer";
+        row(label.str(), b);
+    }
+}
+
+// ResumableSearch in small slices against bestMoveWithin, same fresh tables
+bool checkAgainstBestMove(const Options &opt) {
+    bool ok = true;
+    for (int g = 0; g < 6; ++g) {
+        Board board;
+        char player = MAX_PLAYER;
+        for (int m = 0; m < g; ++m) {
+            board.makeMove((m * 3 + g) % COLS, player);
+            player = (player == MAX_PLAYER) ? MIN_PLAYER : MAX_PLAYER;
+        }
+        int depth = 7;
+        transpositionTable().resize(16);
+        evalCache().clear();
+        uint64_t n0 = g_nodesGenerated;
+        SearchLimits limits;
+        limits.depth = depth;
+        int score = 0;
+        Move ref = bestMoveWithin(board, player, limits, opt.eval, nullptr, &score);
+        uint64_t refNodes = g_nodesGenerated - n0;
+
+        transpositionTable().resize(16);
+        evalCache().clear();
+        ResumableSearch s(board, player, depth, opt.eval);
+        while (!s.step(97)) {}
+        if (s.move().col != ref.col || s.score() != score || s.nodes() != refNodes) {
+            cout << "mismatch after " << g << " moves: resumable " << s.move().col << "/" << s.score()
+                 << "/" << s.nodes() << " nodes, bestMoveWithin " << ref.col << "/" << score
+                 << "/" << refNodes << " nodes\n";
+            ok = false;
+        }
+    }
+    transpositionTable().resize(0);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    bool threadPerGame = true;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool more = i + 1 < argc;
+        if (arg == "--games" && more)         opt.games = atoi(argv[++i]);
+        else if (arg == "--moves" && more)    opt.moves = atoi(argv[++i]);
+        else if (arg == "--threads" && more)  opt.threads = atoi(argv[++i]);
+        else if (arg == "--depth" && more)    opt.depth = atoi(argv[++i]);
+        else if (arg == "--quantum" && more)  opt.quantum = atoll(argv[++i]);
+        else if (arg == "--think-ms" && more) opt.thinkMs = atof(argv[++i]);
+        else if (arg == "--tt-mb" && more)    opt.ttMB = atol(argv[++i]);
+        else if (arg == "--no-threads")       threadPerGame = false;
+        else if (arg == "--eval" && more && parseEvalKind(argv[i+1], opt.eval)) ++i;
+        else if (arg == "--budgets" && more) {
+            opt.budgets.clear();
+            stringstream ss(argv[++i]);
+            string item;
+            while (getline(ss, item, ',')) opt.budgets.push_back(atof(item.c_str()));
+        } else {
+            cerr << "Usage: " << argv[0] << " [--games N] [--moves N] [--threads N] [--depth D]"
+                 << " [--quantum NODES] [--budgets MS,MS,...] [--think-ms MS] [--tt-mb N]"
+                 << " [--eval side|center|sparse|tuned] [--no-threads]" << endl;
+            return 1;
+        }
+    }
+    if (opt.threads < 1) opt.threads = 1;
+    if (opt.games < 1 || opt.moves < 1 || opt.budgets.empty()) { cerr << "nothing to run" << endl; return 1; }
+    evalCache().resize(256);
+
+    bool same = checkAgainstBestMove(opt);
+    cout << "resumable search vs bestMoveWithin (6 positions, depth 7): "
+         << (same ? "same moves, scores and node counts" : "MISMATCH") << "\n\n";
+
+    cout << opt.games << " games x " << opt.moves << " moves, " << opt.threads << " pool threads, "
+         << opt.quantum << "-node slices, depth <= " << opt.depth << ", think <= " << opt.thinkMs
+         << " ms\n\n" << left << fixed << setprecision(1)
+         << setw(18) << "run" << setw(8) << "moves" << setw(10) << "p50(ms)" << setw(10) << "p95(ms)"
+         << setw(10) << "p99(ms)" << setw(10) << "max(ms)" << setw(9) << "late%" << "depth\n";
+    {
+        SharedTranspositionTable tt(opt.ttMB);
+        report("deadline-first", runScheduled(opt, true, tt), opt.budgets);
+    }
+    {
+        SharedTranspositionTable tt(opt.ttMB);
+        report("round-robin", runScheduled(opt, false, tt), opt.budgets);
+    }
+    if (threadPerGame) {
+        SharedTranspositionTable tt(opt.ttMB);
+        report("thread per game", runThreadPerGame(opt, tt), opt.budgets);
+    }
+    return same ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+// scheduler.h
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <cstdint>
+#include <vector>
+#include <queue>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include "resumable.h"
+#include "transposition.h"
+
+// runs many ResumableSearch tasks on a small fixed pool of threads. a thread
+// takes the ready task with the earliest deadline, steps it for 'quantum'
+// nodes and puts it back unless it finished, so the game whose move timer
+// runs out first always gets the next slice; tasks with the same deadline
+// (or none) take turns in submission order.
+class SearchScheduler {
+public:
+    typedef ResumableSearch::Clock Clock;
+    typedef std::function<void(ResumableSearch &)> Done;
+
+    // each pool thread gets a ttMB table, or all of them share 'shared'
+    SearchScheduler(int threads, uint64_t quantum, size_t ttMB,
+                    SharedTranspositionTable *shared = nullptr, bool deadlineFirst = true)
+        : quantum(quantum), deadlineFirst(deadlineFirst) {
+        for (int i = 0; i < threads; ++i)
+            pool.emplace_back([this, ttMB, shared] { worker(ttMB, shared); });
+    }
+
+    ~SearchScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto &t : pool) t.join();
+    }
+
+    // queue a search; 'done' runs on a pool thread when it finishes
+    void submit(const ResumableSearch &search, Clock::time_point deadline, Done done) {
+        auto task = std::make_shared<Task>();
+        task->search = search;
+        task->deadline = deadline;
+        task->done = std::move(done);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            push(task);
+        }
+        cv.notify_one();
+    }
+
+    uint64_t slices() const { return sliceCount; }
+
+private:
+    struct Task {
+        ResumableSearch search;
+        Clock::time_point deadline;
+        uint64_t turn = 0;        // order among equal deadlines
+        Done done;
+    };
+    typedef std::shared_ptr<Task> TaskPtr;
+
+    struct Later {
+        bool deadlineFirst;
+        bool operator()(const TaskPtr &a, const TaskPtr &b) const {
+            if (deadlineFirst && a->deadline != b->deadline) return a->deadline > b->deadline;
+            return a->turn > b->turn;
+        }
+    };
+
+    uint64_t quantum;
+    bool deadlineFirst;
+    std::vector<std::thread> pool;
+    std::priority_queue<TaskPtr, std::vector<TaskPtr>, Later> ready{Later{deadlineFirst}};
+    std::mutex mtx;
+    std::condition_variable cv;
+    uint64_t turns = 0;
+    uint64_t sliceCount = 0;
+    bool stopping = false;
+
+    void push(const TaskPtr &task) {
+        task->turn = turns++;
+        ready.push(task);
+    }
+
+    void worker(size_t ttMB, SharedTranspositionTable *shared) {
+        if (shared) transpositionTable().attach(shared);
+        else transpositionTable().resize(ttMB);
+        for (;;) {
+            TaskPtr task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return stopping || !ready.empty(); });
+                if (ready.empty()) return;
+                task = ready.top();
+                ready.pop();
+                ++sliceCount;
+            }
+            if (task->search.step(quantum)) {
+                task->done(task->search);
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                push(task);
+            }
+            cv.notify_one();
+        }
+    }
+};
+
+#endif // SCHEDULER_H
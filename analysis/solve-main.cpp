@@ -0,0 +1,115 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include "board.h"
+#include "positions.h"
+#include "pnsearch.h"
+
+// df-pn solver front-end.
+//
+//   solve-main [--moves "3 3 4 ..."] [--label] [--nodes N] [--tt-mb N]
+//       prove or disprove a win for the side to move after the given moves
+//       (X first); with --label also decide loss or draw
+//   solve-main --ply N [--nodes N] [--tt-mb N]
+//       label every distinct undecided position after N moves
+
+using Clock = chrono::steady_clock;
+
+double msSince(Clock::time_point t0) {
+    return chrono::duration<double, milli>(Clock::now() - t0).count();
+}
+
+void printStats(const DfpnStats &s) {
+    cout << "nodes " << s.nodes << ", proof size " << s.proofSize
+         << (s.proofComplete ? "" : " (partly evicted)")
+         << ", table hits " << s.hits << "/" << s.lookups
+         << ", evictions " << s.evictions;
+}
+
+int main(int argc, char* argv[]) {
+    string moves;
+    int ply = -1;
+    bool label = false;
+    uint64_t nodeLimit = 0;
+    size_t tableMB = 64;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--moves" && i + 1 < argc)      moves = argv[++i];
+        else if (arg == "--ply" && i + 1 < argc)   ply = atoi(argv[++i]);
+        else if (arg == "--label")                 label = true;
+        else if (arg == "--nodes" && i + 1 < argc) nodeLimit = atoll(argv[++i]);
+        else if (arg == "--tt-mb" && i + 1 < argc) tableMB = atol(argv[++i]);
+        else {
+            cerr << "Usage: " << argv[0] << " [--moves \"C1 C2 ...\"] [--label]"
+                 << " [--nodes N] [--tt-mb N]\n"
+                 << "       " << argv[0] << " --ply N [--nodes N] [--tt-mb N]" << endl;
+            return 1;
+        }
+    }
+    DfpnSolver solver(tableMB);
+
+    if (ply >= 0) {
+        // every distinct position after 'ply' moves nobody has won yet
+        vector<BitPosition> positions;
+        for (uint64_t key : enumeratePositions(ply)) positions.push_back(positionFromKey(key));
+
+        size_t counts[4] = {0, 0, 0, 0};
+        uint64_t nodes = 0;
+        auto t0 = Clock::now();
+        // the table is kept across positions: settled entries stay true and
+        // open ones are only estimates, so reuse is safe and saves work
+        for (const BitPosition &pos : positions) {
+            PositionLabel l = labelPosition(solver, pos, nodeLimit);
+            ++counts[l];
+            nodes += solver.stats.nodes;
+        }
+        double ms = msSince(t0);
+        cout << positions.size() << " positions at ply " << ply << " (side to move): "
+             << "win " << counts[LABEL_WIN] << ", loss " << counts[LABEL_LOSS]
+             << ", draw " << counts[LABEL_DRAW] << ", unknown " << counts[LABEL_UNKNOWN]
+             << "\n" << nodes << " nodes in " << fixed << setprecision(1) << ms << " ms ("
+             << setprecision(3) << (positions.empty() ? 0.0 : ms / positions.size())
+             << " ms per position)\n";
+        return 0;
+    }
+
+    BitPosition pos;
+    stringstream ss(moves);
+    int col;
+    while (ss >> col) {
+        if (col < 0 || col >= COLS || !pos.canPlay(col)) { cerr << "illegal move " << col << endl; return 1; }
+        if (pos.isWinningMove(col)) { cerr << "the game is already won at move " << col << endl; return 1; }
+        pos.play(col);
+    }
+    if (pos.isFull()) { cerr << "the board is full" << endl; return 1; }
+    char side = pos.toMove == 0 ? MAX_PLAYER : MIN_PLAYER;
+
+    auto t0 = Clock::now();
+    int winCol = -1;
+    DfpnResult r = solver.solve(pos, nodeLimit, &winCol);
+    double ms = msSince(t0);
+    cout << side << " to move: "
+         << (r == DFPN_PROVEN ? "forced win" : r == DFPN_DISPROVEN ? "no forced win" : "unknown (node limit)");
+    if (r == DFPN_PROVEN) cout << ", play " << winCol;
+    cout << "\n  ";
+    printStats(solver.stats);
+    cout << ", " << fixed << setprecision(1) << ms << " ms\n";
+
+    if (label && r == DFPN_DISPROVEN) {
+        t0 = Clock::now();
+        DfpnResult other = solver.solveFor(pos, pos.toMove ^ 1, nodeLimit);
+        ms = msSince(t0);
+        cout << "opponent: "
+             << (other == DFPN_PROVEN ? "forced win, so this is a loss"
+                 : other == DFPN_DISPROVEN ? "no forced win, so this is a draw" : "unknown (node limit)")
+             << "\n  ";
+        printStats(solver.stats);
+        cout << ", " << ms << " ms\n";
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+// sprt.h
+#ifndef SPRT_H
+#define SPRT_H
+
+#include <cmath>
+
+// sequential probability ratio test for engine-vs-engine matches.
+// H0: the elo difference is elo0, H1: it is elo1. after every game the log
+// likelihood ratio is compared against bounds derived from the allowed
+// error rates; the match stops as soon as it crosses one of them. uses the
+// normal approximation of the trinomial (win/draw/loss) score distribution.
+
+enum SprtDecision { SPRT_CONTINUE = 0, SPRT_ACCEPT_H0 = -1, SPRT_ACCEPT_H1 = 1 };
+
+inline double eloToScore(double elo) { return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0)); }
+
+inline double scoreToElo(double s) {
+    if (s <= 0.0) return -1000.0;
+    if (s >= 1.0) return 1000.0;
+    return -400.0 * std::log10(1.0 / s - 1.0);
+}
+
+class Sprt {
+public:
+    int wins = 0, draws = 0, losses = 0;
+
+    Sprt(double elo0 = 0, double elo1 = 20, double alpha = 0.05, double beta = 0.05)
+        : elo0(elo0), elo1(elo1),
+          lowerBound(std::log(beta / (1 - alpha))),
+          upperBound(std::log((1 - beta) / alpha)) {}
+
+    // score of one game from the first engine's point of view: 1, 0.5 or 0
+    void add(double score) {
+        if (score > 0.75) ++wins;
+        else if (score > 0.25) ++draws;
+        else ++losses;
+    }
+
+    int games() const { return wins + draws + losses; }
+    double score() const { return games() ? (wins + 0.5 * draws) / games() : 0.5; }
+    double elo() const { return scoreToElo(score()); }
+    double lower() const { return lowerBound; }
+    double upper() const { return upperBound; }
+
+    double llr() const {
+        int n = games();
+        if (n == 0) return 0.0;
+        double s = score();
+        // the spread is estimated with half a pseudo-game in each outcome,
+        // otherwise a short run of identical results has zero variance and
+        // the test would stop on it
+        double w = wins + 0.5, d = draws + 0.5, l = losses + 0.5, t = w + d + l;
+        double m = (w + 0.5 * d) / t;
+        double var = (w * (1 - m) * (1 - m) + d * (0.5 - m) * (0.5 - m) + l * m * m) / t;
+        double s0 = eloToScore(elo0), s1 = eloToScore(elo1);
+        return n * (s1 - s0) * (2 * s - s0 - s1) / (2 * var);
+    }
+
+    SprtDecision decision() const {
+        double l = llr();
+        if (l >= upperBound) return SPRT_ACCEPT_H1;
+        if (l <= lowerBound) return SPRT_ACCEPT_H0;
+        return SPRT_CONTINUE;
+    }
+
+private:
+    double elo0, elo1;
+    double lowerBound, upperBound;
+};
+
+#endif // SPRT_H
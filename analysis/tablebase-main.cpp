@@ -0,0 +1,362 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <queue>
+#include <array>
+#include <memory>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "board.h"
+#include "tablebase.h"
+
+// retrograde tablebase generator for the board this is compiled for, e.g.
+//   g++ -std=c++17 -O2 -pthread -DC4_ROWS=5 -DC4_COLS=5 tablebase-main.cpp
+//
+//   tablebase-main [--out FILE] [--threads N] [--mem-mb N] [--tmp DIR]
+//       generate the tablebase
+//   tablebase-main --probe FILE [--moves "C1 C2 ..."]
+//       value and best move of a position (X first)
+//
+// generation runs in two passes over the positions grouped by piece count,
+// each group kept in its own sorted key file under --tmp:
+//   forward:  group k is every undecided child of group k-1. threads expand
+//             slices of k-1 into their own buffers; a full buffer is sorted
+//             and spilled as a run file, and the runs are merged (dropping
+//             duplicates) into group k, so memory stays within --mem-mb.
+//   backward: from the last group down, each position is valued from its
+//             children in group k+1 (binary search in that mapped file).
+// the groups are then packed with their directories into one file.
+
+using Clock = chrono::steady_clock;
+
+string levelPath(const string &dir, int level, const char *ext) {
+    return dir + "/tb-" + to_string(ROWS) + "x" + to_string(COLS) + "-" + to_string(level) + ext;
+}
+
+bool writeAll(const string &path, const void *data, size_t bytes) {
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = bytes == 0 || fwrite(data, 1, bytes, f) == bytes;
+    return (fclose(f) == 0) && ok;
+}
+
+// buffered sequential reader of a run of sorted keys
+struct RunReader {
+    FILE *f = nullptr;
+    vector<uint64_t> buf;
+    size_t pos = 0, len = 0;
+    explicit RunReader(const string &path) : f(fopen(path.c_str(), "rb")), buf(1 << 14) {}
+    ~RunReader() { if (f) fclose(f); }
+    bool next(uint64_t &key) {
+        if (pos == len) {
+            len = f ? fread(buf.data(), sizeof(uint64_t), buf.size(), f) : 0;
+            pos = 0;
+            if (len == 0) return false;
+        }
+        key = buf[pos++];
+        return true;
+    }
+};
+
+// merge sorted runs into one sorted, duplicate-free key file; returns its
+// length or -1 on error
+int64_t mergeRuns(const vector<string> &runs, const string &outPath) {
+    vector<unique_ptr<RunReader>> readers;
+    typedef pair<uint64_t, size_t> Head;
+    priority_queue<Head, vector<Head>, greater<Head>> heads;
+    for (const string &r : runs) {
+        readers.emplace_back(new RunReader(r));
+        uint64_t k;
+        if (readers.back()->next(k)) heads.push({k, readers.size() - 1});
+    }
+    FILE *out = fopen(outPath.c_str(), "wb");
+    if (!out) return -1;
+    vector<uint64_t> buf;
+    buf.reserve(1 << 14);
+    int64_t count = 0;
+    bool ok = true, any = false;
+    uint64_t last = 0;
+    while (!heads.empty()) {
+        Head h = heads.top();
+        heads.pop();
+        if (!any || h.first != last) {
+            buf.push_back(h.first);
+            last = h.first;
+            any = true;
+            ++count;
+            if (buf.size() == buf.capacity()) {
+                ok = ok && fwrite(buf.data(), sizeof(uint64_t), buf.size(), out) == buf.size();
+                buf.clear();
+            }
+        }
+        uint64_t k;
+        if (readers[h.second]->next(k)) heads.push({k, h.second});
+    }
+    ok = ok && (buf.empty() || fwrite(buf.data(), sizeof(uint64_t), buf.size(), out) == buf.size());
+    ok = (fclose(out) == 0) && ok;
+    for (const string &r : runs) remove(r.c_str());
+    return ok ? count : -1;
+}
+
+// read-only mapping of a key or value file
+template <class T>
+struct MappedArray {
+    const T *data = nullptr;
+    size_t count = 0;
+    size_t bytes = 0;
+    bool open(const string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        fstat(fd, &st);
+        bytes = st.st_size;
+        count = bytes / sizeof(T);
+        if (bytes) {
+            void *p = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) { ::close(fd); return false; }
+            data = static_cast<const T *>(p);
+        }
+        ::close(fd);
+        return true;
+    }
+    ~MappedArray() { if (data) munmap(const_cast<T *>(data), bytes); }
+};
+
+template <class Fn>
+void parallelFor(int threads, size_t n, Fn fn) {
+    atomic<size_t> next{0};
+    const size_t chunk = 4096;
+    auto worker = [&](int id) {
+        for (size_t start; (start = next.fetch_add(chunk)) < n; )
+            fn(id, start, min(n, start + chunk));
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto &t : pool) t.join();
+}
+
+// group 'level' from group level-1; returns its size or -1
+int64_t expandLevel(const string &dir, int level, int threads, size_t memBytes) {
+    MappedArray<uint64_t> parents;
+    if (!parents.open(levelPath(dir, level - 1, ".keys"))) return -1;
+    size_t perThread = max<size_t>(1 << 16, memBytes / sizeof(uint64_t) / threads);
+    vector<vector<uint64_t>> bufs(threads);
+    vector<string> runs;
+    mutex runMtx;
+    atomic<bool> failed{false};
+    auto spill = [&](vector<uint64_t> &buf) {
+        if (buf.empty()) return;
+        sort(buf.begin(), buf.end());
+        buf.erase(unique(buf.begin(), buf.end()), buf.end());
+        string path;
+        {
+            lock_guard<mutex> lock(runMtx);
+            path = levelPath(dir, level, ".run") + to_string(runs.size());
+            runs.push_back(path);
+        }
+        if (!writeAll(path, buf.data(), buf.size() * sizeof(uint64_t))) failed = true;
+        buf.clear();
+    };
+    parallelFor(threads, parents.count, [&](int id, size_t from, size_t to) {
+        vector<uint64_t> &buf = bufs[id];
+        for (size_t i = from; i < to; ++i) {
+            BitPosition pos = positionFromKey(parents.data[i]);
+            for (int c = 0; c < COLS; ++c) {
+                if (!pos.canPlay(c) || pos.isWinningMove(c)) continue;
+                BitPosition next = pos;
+                next.play(c);
+                if (!next.isFull()) buf.push_back(next.key());
+            }
+            if (buf.size() + COLS > perThread) spill(buf);
+        }
+    });
+    for (auto &buf : bufs) spill(buf);
+    if (failed) return -1;
+    return mergeRuns(runs, levelPath(dir, level, ".keys"));
+}
+
+// values of group 'level' from group level+1 (already valued)
+bool valueLevel(const string &dir, int level, int threads, uint64_t counts[4]) {
+    MappedArray<uint64_t> keys, childKeys;
+    MappedArray<uint8_t> childValues;
+    if (!keys.open(levelPath(dir, level, ".keys"))) return false;
+    if (level + 1 < ROWS * COLS) {
+        if (!childKeys.open(levelPath(dir, level + 1, ".keys"))
+            || !childValues.open(levelPath(dir, level + 1, ".vals")))
+            return false;
+    }
+    auto probe = [&](const BitPosition &next, TbValue &v) {
+        uint64_t key = next.key();
+        const uint64_t *end = childKeys.data + childKeys.count;
+        const uint64_t *k = lower_bound(childKeys.data, end, key);
+        if (k == end || *k != key) return false;
+        v = childValues.data[k - childKeys.data];
+        return true;
+    };
+    vector<uint8_t> values(keys.count);
+    atomic<bool> missing{false};
+    vector<array<uint64_t, 3>> tally(threads, array<uint64_t, 3>{0, 0, 0});
+    parallelFor(threads, keys.count, [&](int id, size_t from, size_t to) {
+        for (size_t i = from; i < to; ++i) {
+            int col;
+            TbValue v = TB_DRAW;
+            if (!tbBestMove(positionFromKey(keys.data[i]), probe, col, v)) missing = true;
+            values[i] = v;
+            ++tally[id][tbIsWin(v) ? 0 : tbIsLoss(v) ? 1 : 2];
+        }
+    });
+    for (auto &t : tally) { counts[0] += t[0]; counts[1] += t[1]; counts[2] += t[2]; }
+    if (missing) { cerr << "group " << level << ": a child position is missing" << endl; return false; }
+    return writeAll(levelPath(dir, level, ".vals"), values.data(), values.size());
+}
+
+// pack every group with its directory into the final file
+bool packTablebase(const string &dir, const string &outPath, uint64_t total) {
+    FILE *out = fopen(outPath.c_str(), "wb");
+    if (!out) return false;
+    TablebaseHeader h;
+    memcpy(h.magic, "C4TB", 4);
+    h.version = TABLEBASE_VERSION;
+    h.rows = ROWS; h.cols = COLS;
+    h.positions = total;
+    vector<TablebaseLevel> levels(ROWS * COLS);
+    uint64_t offset = sizeof h + levels.size() * sizeof(TablebaseLevel);
+    bool ok = fwrite(&h, sizeof h, 1, out) == 1
+           && fwrite(levels.data(), sizeof(TablebaseLevel), levels.size(), out) == levels.size();
+
+    for (int l = 0; l < ROWS * COLS && ok; ++l) {
+        MappedArray<uint64_t> keys;
+        MappedArray<uint8_t> values;
+        ok = keys.open(levelPath(dir, l, ".keys")) && values.open(levelPath(dir, l, ".vals"));
+        if (!ok) break;
+        TablebaseLevel &lv = levels[l];
+        lv.count = keys.count;
+        lv.dirBits = tbDirBits(keys.count);
+        vector<uint32_t> dirIndex((size_t(1) << lv.dirBits) + 1);
+        size_t i = 0;
+        for (size_t s = 0; s < dirIndex.size(); ++s) {
+            while (i < keys.count && tbDirSlot(keys.data[i], lv.dirBits) < s) ++i;
+            dirIndex[s] = uint32_t(i);
+        }
+        dirIndex.back() = uint32_t(keys.count);
+
+        lv.keysOffset = offset;
+        offset += keys.bytes;
+        lv.dirOffset = offset;
+        offset += dirIndex.size() * sizeof(uint32_t);
+        lv.valuesOffset = offset;
+        offset += values.bytes;
+        uint64_t pad = (8 - offset % 8) % 8;
+        offset += pad;
+        static const char zeros[8] = {0};
+        ok = (keys.bytes == 0 || fwrite(keys.data, 1, keys.bytes, out) == keys.bytes)
+          && fwrite(dirIndex.data(), sizeof(uint32_t), dirIndex.size(), out) == dirIndex.size()
+          && (values.bytes == 0 || fwrite(values.data, 1, values.bytes, out) == values.bytes)
+          && fwrite(zeros, 1, pad, out) == pad;
+    }
+    ok = ok && fseek(out, sizeof h, SEEK_SET) == 0
+       && fwrite(levels.data(), sizeof(TablebaseLevel), levels.size(), out) == levels.size();
+    return (fclose(out) == 0) && ok;
+}
+
+int probeMain(const string &path, const string &moves) {
+    Tablebase &tb = tablebase();
+    if (!tb.open(path)) {
+        cerr << "cannot open " << path << " (is it a " << ROWS << "x" << COLS << " tablebase?)" << endl;
+        return 1;
+    }
+    BitPosition pos;
+    stringstream ss(moves);
+    int c;
+    while (ss >> c) {
+        if (c < 0 || c >= COLS || !pos.canPlay(c)) { cerr << "illegal move " << c << endl; return 1; }
+        if (pos.isWinningMove(c)) { cerr << "the game is already won at move " << c << endl; return 1; }
+        pos.play(c);
+    }
+    if (pos.isFull()) { cerr << "the board is full" << endl; return 1; }
+    auto t0 = Clock::now();
+    int col;
+    TbValue v;
+    bool found = tb.bestMove(pos, col, v);
+    double us = chrono::duration<double, micro>(Clock::now() - t0).count();
+    if (!found) { cerr << "position not in the tablebase" << endl; return 1; }
+    cout << (pos.toMove == 0 ? MAX_PLAYER : MIN_PLAYER) << " to move: "
+         << (tbIsWin(v) ? "win" : tbIsLoss(v) ? "loss" : "draw");
+    if (v != TB_DRAW) cout << " in " << tbPlies(v) << " plies";
+    cout << ", best move " << col << " (" << fixed << setprecision(1) << us << " us)\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    string outPath = "tb-" + to_string(ROWS) + "x" + to_string(COLS) + ".bin";
+    string tmpDir = ".", probePath, moves;
+    int threads = int(thread::hardware_concurrency());
+    size_t memMB = 256;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool more = i + 1 < argc;
+        if (arg == "--out" && more)          outPath = argv[++i];
+        else if (arg == "--threads" && more) threads = atoi(argv[++i]);
+        else if (arg == "--mem-mb" && more)  memMB = atol(argv[++i]);
+        else if (arg == "--tmp" && more)     tmpDir = argv[++i];
+        else if (arg == "--probe" && more)   probePath = argv[++i];
+        else if (arg == "--moves" && more)   moves = argv[++i];
+        else {
+            cerr << "Usage: " << argv[0] << " [--out FILE] [--threads N] [--mem-mb N] [--tmp DIR]\n"
+                 << "       " << argv[0] << " --probe FILE [--moves \"C1 C2 ...\"]" << endl;
+            return 1;
+        }
+    }
+    if (!probePath.empty()) return probeMain(probePath, moves);
+    if (threads < 1) threads = 1;
+
+    cout << "tablebase " << ROWS << "x" << COLS << ", " << threads << " threads, "
+         << memMB << " MB spill budget" << endl;
+    auto t0 = Clock::now();
+    uint64_t root = BitPosition().key();
+    if (!writeAll(levelPath(tmpDir, 0, ".keys"), &root, sizeof root)) {
+        cerr << "cannot write to " << tmpDir << endl;
+        return 1;
+    }
+    uint64_t total = 1;
+    for (int l = 1; l < ROWS * COLS; ++l) {
+        int64_t n = expandLevel(tmpDir, l, threads, memMB * 1024 * 1024);
+        if (n < 0) { cerr << "forward pass failed at group " << l << endl; return 1; }
+        total += n;
+    }
+    double fwdSecs = chrono::duration<double>(Clock::now() - t0).count();
+    cout << total << " undecided positions, forward pass " << fixed << setprecision(2)
+         << fwdSecs << " s" << endl;
+
+    uint64_t counts[4] = {0, 0, 0, 0};
+    for (int l = ROWS * COLS - 1; l >= 0; --l)
+        if (!valueLevel(tmpDir, l, threads, counts)) { cerr << "backward pass failed" << endl; return 1; }
+    double bwdSecs = chrono::duration<double>(Clock::now() - t0).count() - fwdSecs;
+    cout << "win " << counts[0] << ", loss " << counts[1] << ", draw " << counts[2]
+         << " (side to move), backward pass " << bwdSecs << " s" << endl;
+
+    if (!packTablebase(tmpDir, outPath, total)) { cerr << "could not write " << outPath << endl; return 1; }
+    for (int l = 0; l < ROWS * COLS; ++l) {
+        remove(levelPath(tmpDir, l, ".keys").c_str());
+        remove(levelPath(tmpDir, l, ".vals").c_str());
+    }
+    Tablebase &tb = tablebase();
+    if (!tb.open(outPath)) { cerr << "the written file does not load" << endl; return 1; }
+    int col;
+    TbValue v;
+    tb.bestMove(BitPosition(), col, v);
+    cout << "wrote " << outPath << "; empty board: "
+         << (tbIsWin(v) ? "first player wins" : tbIsLoss(v) ? "second player wins" : "draw");
+    if (v != TB_DRAW) cout << " in " << tbPlies(v) << " plies";
+    cout << ", first move " << col << endl;
+    return 0;
+}
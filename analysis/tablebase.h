@@ -0,0 +1,200 @@
+// tablebase.h
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "board.h"
+
+// exact full-game tablebase for small boards (build with -DC4_ROWS/C4_COLS,
+// generated by tablebase-main). every reachable, undecided position is
+// stored with its value for the side to move: win, loss or draw, and in how
+// many plies the game ends with best play (the winner hurrying, the loser
+// holding out).
+//
+// positions are grouped by the number of pieces on the board. each group
+// is a sorted array of position keys, a parallel array of one-byte values
+// and a small directory over the top key bits, so a lookup is one
+// directory read plus a binary search over a handful of keys.
+
+const uint32_t TABLEBASE_VERSION = 1;
+
+// one-byte value: 0 draw, 1..127 win in that many plies, 128+d loss in d
+typedef uint8_t TbValue;
+const TbValue TB_DRAW = 0;
+inline TbValue tbWin(int plies)  { return TbValue(plies); }
+inline TbValue tbLoss(int plies) { return TbValue(128 + plies); }
+inline bool tbIsWin(TbValue v)  { return v >= 1 && v < 128; }
+inline bool tbIsLoss(TbValue v) { return v >= 128; }
+inline int tbPlies(TbValue v)   { return v >= 128 ? v - 128 : v; }
+
+// value of a move into a position whose value (for the opponent) is v
+inline TbValue tbBackUp(TbValue v) {
+    if (tbIsWin(v))  return tbLoss(tbPlies(v) + 1);
+    if (tbIsLoss(v)) return tbWin(tbPlies(v) + 1);
+    return TB_DRAW;
+}
+
+// true if a is better than b for the side to move
+inline bool tbBetter(TbValue a, TbValue b) {
+    auto rank = [](TbValue v) {
+        if (tbIsWin(v))  return 1000 - tbPlies(v);   // faster wins first
+        if (tbIsLoss(v)) return -1000 + tbPlies(v);  // slower losses first
+        return 0;
+    };
+    return rank(a) > rank(b);
+}
+
+// best move from an undecided position given the values of the positions
+// it leads to: probe(next, value) fills in a child's value, returning
+// false if it is unknown (then so is this one)
+template <class Probe>
+inline bool tbBestMove(const BitPosition &pos, Probe probe, int &col, TbValue &value) {
+    col = -1;
+    for (int c = 0; c < COLS; ++c) {
+        if (!pos.canPlay(c)) continue;
+        TbValue v;
+        if (pos.isWinningMove(c)) {
+            v = tbWin(1);
+        } else {
+            BitPosition next = pos;
+            next.play(c);
+            TbValue nv = TB_DRAW;   // a full board without a four is a draw
+            if (!next.isFull() && !probe(next, nv)) return false;
+            v = tbBackUp(nv);
+        }
+        if (col < 0 || tbBetter(v, value)) { col = c; value = v; }
+    }
+    return col >= 0;
+}
+
+// key bits in use, for the directory
+const int TB_KEY_BITS = COL_BITS * COLS;
+
+struct TablebaseHeader {
+    char     magic[4];   // "C4TB"
+    uint32_t version;
+    uint32_t rows, cols;
+    uint64_t positions;
+};
+
+// one group (positions with the same number of pieces)
+struct TablebaseLevel {
+    uint64_t count;
+    uint64_t keysOffset, valuesOffset, dirOffset;  // from the start of the file
+    uint32_t dirBits;                              // directory has 2^dirBits + 1 entries
+    uint32_t pad;
+};
+
+inline uint32_t tbDirBits(uint64_t count) {
+    uint32_t bits = 0;
+    while (bits < 20 && (uint64_t(1) << bits) < count / 4) ++bits;
+    return min(bits, uint32_t(TB_KEY_BITS));
+}
+
+inline size_t tbDirSlot(uint64_t key, uint32_t dirBits) {
+    return dirBits ? size_t(key >> (TB_KEY_BITS - dirBits)) : 0;
+}
+
+class Tablebase {
+public:
+    std::atomic<uint64_t> probes{0}, hits{0};
+
+    ~Tablebase() { close(); }
+
+    bool open(const string &path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0
+               && size_t(st.st_size) >= sizeof(TablebaseHeader) + (ROWS * COLS) * sizeof(TablebaseLevel);
+        if (ok) {
+            base = static_cast<const char *>(mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0));
+            ok = (base != MAP_FAILED);
+            if (!ok) base = nullptr;
+        }
+        ::close(fd);
+        if (!ok) return false;
+        mapBytes = st.st_size;
+        const TablebaseHeader *h = reinterpret_cast<const TablebaseHeader *>(base);
+        if (memcmp(h->magic, "C4TB", 4) != 0 || h->version != TABLEBASE_VERSION
+            || h->rows != uint32_t(ROWS) || h->cols != uint32_t(COLS)) {
+            close();
+            return false;
+        }
+        header = h;
+        levels = reinterpret_cast<const TablebaseLevel *>(h + 1);
+        for (int l = 0; l < ROWS * COLS; ++l) {
+            const TablebaseLevel &lv = levels[l];
+            if (lv.valuesOffset + lv.count > mapBytes
+                || lv.keysOffset + lv.count * 8 > mapBytes
+                || lv.dirOffset + ((uint64_t(1) << lv.dirBits) + 1) * 4 > mapBytes) {
+                close();
+                return false;
+            }
+        }
+        openPath = path;
+        return true;
+    }
+
+    const string &filePath() const { return openPath; }   // empty when closed
+    bool enabled() const { return header != nullptr; }
+    uint64_t positions() const { return header ? header->positions : 0; }
+
+    // value of an undecided position for its side to move
+    bool probe(const BitPosition &pos, TbValue &out) {
+        probes.fetch_add(1, std::memory_order_relaxed);
+        if (!header || pos.moves >= ROWS * COLS) return false;
+        const TablebaseLevel &lv = levels[pos.moves];
+        uint64_t key = pos.key();
+        const uint64_t *keys = reinterpret_cast<const uint64_t *>(base + lv.keysOffset);
+        const uint32_t *dir = reinterpret_cast<const uint32_t *>(base + lv.dirOffset);
+        size_t slot = tbDirSlot(key, lv.dirBits);
+        const uint64_t *lo = keys + dir[slot], *hi = keys + dir[slot + 1];
+        const uint64_t *k = lower_bound(lo, hi, key);
+        if (k == hi || *k != key) return false;
+        out = TbValue(base[lv.valuesOffset + (k - keys)]);
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // best move and its value; false if the position isn't in the table
+    bool bestMove(const BitPosition &pos, int &col, TbValue &value) {
+        return tbBestMove(pos, [this](const BitPosition &p, TbValue &v) { return probe(p, v); },
+                          col, value);
+    }
+
+    void close() {
+        openPath.clear();
+        if (base) munmap(const_cast<char *>(base), mapBytes);
+        base = nullptr;
+        mapBytes = 0;
+        header = nullptr;
+        levels = nullptr;
+    }
+
+private:
+    string openPath;
+    const char *base = nullptr;
+    size_t mapBytes = 0;
+    const TablebaseHeader *header = nullptr;
+    const TablebaseLevel *levels = nullptr;
+};
+
+// the tablebase consulted by bestMove, disabled until opened
+inline Tablebase &tablebase() {
+    static Tablebase tb;
+    return tb;
+}
+
+#endif // TABLEBASE_H
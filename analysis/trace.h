@@ -0,0 +1,133 @@
+// trace.h
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// optional timeline recorder writing chrome trace-event JSON, which opens in
+// Perfetto or chrome://tracing. spans are kept in memory as fixed-size
+// records (names must be string literals) and written out once at flush or
+// exit. while the recorder is off a TraceSpan costs one branch.
+
+const int TRACE_MAX_ARGS = 4;
+
+struct TraceArg {
+    const char *key;
+    int64_t value;
+};
+
+struct TraceEvent {
+    const char *name;
+    const char *cat;
+    int64_t tsUs, durUs;
+    uint32_t tid;
+    int nargs;
+    TraceArg args[TRACE_MAX_ARGS];
+};
+
+// small stable id per thread so each thread gets its own track
+inline uint32_t traceThreadId() {
+    static std::atomic<uint32_t> next{1};
+    thread_local uint32_t id = next.fetch_add(1);
+    return id;
+}
+
+class TraceRecorder {
+public:
+    ~TraceRecorder() { flush(); }
+
+    // start recording; the file is written on flush() or at exit
+    void start(const std::string &filePath) {
+        path = filePath;
+        events.reserve(1 << 16);
+        t0 = std::chrono::steady_clock::now();
+        on.store(true, std::memory_order_release);
+    }
+
+    bool enabled() const { return on.load(std::memory_order_relaxed); }
+
+    int64_t nowUs() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - t0).count();
+    }
+
+    void record(const TraceEvent &e) {
+        std::lock_guard<std::mutex> lock(mtx);
+        events.push_back(e);
+    }
+
+    size_t size() const { return events.size(); }
+
+    bool flush() {
+        if (!enabled()) return true;
+        std::lock_guard<std::mutex> lock(mtx);
+        FILE *f = fopen(path.c_str(), "w");
+        if (!f) return false;
+        fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        for (size_t i = 0; i < events.size(); ++i) {
+            const TraceEvent &e = events[i];
+            fprintf(f, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,"
+                       "\"pid\":1,\"tid\":%u,\"args\":{",
+                    e.name, e.cat, (long long)e.tsUs, (long long)e.durUs, e.tid);
+            for (int a = 0; a < e.nargs; ++a)
+                fprintf(f, "%s\"%s\":%lld", a ? "," : "", e.args[a].key, (long long)e.args[a].value);
+            fprintf(f, "}}%s\n", i + 1 < events.size() ? "," : "");
+        }
+        fprintf(f, "]}\n");
+        bool ok = fclose(f) == 0;
+        events.clear();
+        on.store(false);
+        return ok;
+    }
+
+private:
+    std::string path;
+    std::vector<TraceEvent> events;
+    std::mutex mtx;
+    std::atomic<bool> on{false};
+    std::chrono::steady_clock::time_point t0;
+};
+
+inline TraceRecorder &traceRecorder() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+// scoped span: recorded as one complete ("X") event when it goes out of scope
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name, const char *cat = "search") {
+        active = traceRecorder().enabled();
+        if (!active) return;
+        ev.name = name;
+        ev.cat = cat;
+        ev.nargs = 0;
+        ev.tid = traceThreadId();
+        ev.tsUs = traceRecorder().nowUs();
+    }
+
+    ~TraceSpan() {
+        if (!active) return;
+        ev.durUs = traceRecorder().nowUs() - ev.tsUs;
+        traceRecorder().record(ev);
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    void arg(const char *key, int64_t value) {
+        if (active && ev.nargs < TRACE_MAX_ARGS) ev.args[ev.nargs++] = {key, value};
+    }
+
+private:
+    bool active;
+    TraceEvent ev;
+};
+
+#endif // TRACE_H
@@ -0,0 +1,405 @@
+// transposition.h
+#ifndef TRANSPOSITION_H
+#define TRANSPOSITION_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <memory>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// transposition table: a fixed-size cache of search results (not static
+// scores, see evalcache.h). the size is set in MB up front and never grows.
+//
+// every bucket is one 64-byte cache line of eight packed 64-bit entries.
+// the first TT_DEPTH_SLOTS entries are depth-preferred: they only give way
+// to a deeper result or to one from a newer search. the rest are
+// always-replace slots that take whatever the depth-preferred tier refused,
+// so fresh shallow results are still kept around for a while.
+
+enum TTBound { BOUND_NONE = 0, BOUND_UPPER = 1, BOUND_LOWER = 2, BOUND_EXACT = 3 };
+
+// side-to-move bit folded into Board::key() for table lookups (bits 52-60
+// carry the evaluator, see searchKey())
+const uint64_t TT_MAX_TO_MOVE = uint64_t(1) << 62;
+// set in the keys of searches that resolve threats at the horizon
+const uint64_t TT_THREATS = uint64_t(1) << 61;
+
+const int TT_BUCKET_SLOTS = 8;
+const int TT_DEPTH_SLOTS  = 4;
+
+// packed entry layout (low bit first):
+//   check  24  upper bits of the hashed key, verifies the slot owner
+//   score  20  signed search score (evaluations stay within +-100000)
+//   depth   6  remaining depth the score was searched to
+//   bound   2  TTBound, BOUND_NONE marks an empty slot
+//   move    4  best column, 15 when there is none
+//   age     8  search generation that wrote the entry
+struct TTEntry {
+    int score = 0;
+    int depth = 0;
+    int bound = BOUND_NONE;
+    int move  = -1;
+    int age   = 0;
+};
+
+inline uint64_t ttPack(uint32_t check, const TTEntry &e) {
+    return  uint64_t(check & 0xFFFFFF)
+         | (uint64_t(uint32_t(e.score) & 0xFFFFF) << 24)
+         | (uint64_t(e.depth & 0x3F) << 44)
+         | (uint64_t(e.bound & 0x3) << 50)
+         | (uint64_t(e.move < 0 ? 15 : e.move) << 52)
+         | (uint64_t(e.age & 0xFF) << 56);
+}
+
+inline TTEntry ttUnpack(uint64_t w) {
+    TTEntry e;
+    e.score = int32_t(uint32_t(w >> 24) << 12) >> 12;  // sign-extend 20 bits
+    e.depth = int(w >> 44) & 0x3F;
+    e.bound = int(w >> 50) & 0x3;
+    e.move  = int(w >> 52) & 0xF;
+    if (e.move == 15) e.move = -1;
+    e.age   = int(w >> 56) & 0xFF;
+    return e;
+}
+
+inline uint32_t ttCheck(uint64_t w) { return uint32_t(w & 0xFFFFFF); }
+
+struct alignas(64) TTBucket {
+    uint64_t slot[TT_BUCKET_SLOTS];
+};
+
+// counters reported next to Metrics
+struct TTStats {
+    uint64_t probes = 0, hits = 0, stores = 0;
+    uint64_t depthReplaced  = 0;  // depth-preferred slot overwritten by another position
+    uint64_t alwaysReplaced = 0;  // always-replace slot overwritten by another position
+};
+
+// lock-free table shared by any number of threads (lockless hashing).
+// a slot is two 64-bit words, key ^ data and data, written and read with
+// plain relaxed atomics and no locks. a reader racing a writer may see one
+// word from each store; the key it rebuilds from such a torn pair does not
+// match, so the read counts as a miss instead of returning another
+// position's result. full keys are stored, so there are no check-bit
+// collisions either. four slots per 64-byte bucket, same packed data as
+// the per-thread table.
+const int STT_BUCKET_SLOTS = 4;
+
+struct alignas(64) SharedTTBucket {
+    struct Slot {
+        std::atomic<uint64_t> keyXorData{0};
+        std::atomic<uint64_t> data{0};
+    } slot[STT_BUCKET_SLOTS];
+};
+
+class SharedTranspositionTable {
+public:
+    SharedTranspositionTable() {}
+    explicit SharedTranspositionTable(size_t sizeMB) { resize(sizeMB); }
+
+    // not thread-safe: size the table before threads use it
+    void resize(size_t sizeMB) {
+        buckets.reset();
+        mask = 0;
+        if (sizeMB == 0) return;
+        size_t n = 1;
+        while (n * 2 * sizeof(SharedTTBucket) <= sizeMB * 1024 * 1024) n *= 2;
+        buckets.reset(new SharedTTBucket[n]);
+        mask = n - 1;
+    }
+
+    bool enabled() const { return buckets != nullptr; }
+    size_t sizeBytes() const { return buckets ? (mask + 1) * sizeof(SharedTTBucket) : 0; }
+
+    void newSearch() { generation.fetch_add(1, std::memory_order_relaxed); }
+
+    bool probe(uint64_t key, TTEntry &out) const {
+        const SharedTTBucket &b = buckets[mix(key) & mask];
+        for (const auto &s : b.slot) {
+            uint64_t data = s.data.load(std::memory_order_relaxed);
+            uint64_t kx = s.keyXorData.load(std::memory_order_relaxed);
+            if (data && (kx ^ data) == key) {
+                out = ttUnpack(data);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // returns true when another position's entry was overwritten
+    bool store(uint64_t key, int score, int depth, TTBound bound, int move) {
+        SharedTTBucket &b = buckets[mix(key) & mask];
+        int age = generation.load(std::memory_order_relaxed) & 0xFF;
+        TTEntry e;
+        e.score = score;
+        e.depth = depth < 63 ? depth : 63;
+        e.bound = bound;
+        e.move  = move;
+        e.age   = age;
+
+        // same rules as the per-thread table, squeezed into one tier: a
+        // slot of this position is refreshed unless it holds a deeper
+        // result of the current search, otherwise the shallowest (older
+        // searches counting as shallowest) goes
+        int victim = 0, victimDepth = 1 << 30;
+        bool same = false;
+        for (int i = 0; i < STT_BUCKET_SLOTS; ++i) {
+            uint64_t data = b.slot[i].data.load(std::memory_order_relaxed);
+            uint64_t kx = b.slot[i].keyXorData.load(std::memory_order_relaxed);
+            if (data && (kx ^ data) == key) {
+                TTEntry old = ttUnpack(data);
+                if (old.age == age && old.depth > depth && bound != BOUND_EXACT) return false;
+                if (e.move < 0) e.move = old.move;
+                victim = i;
+                same = true;
+                break;
+            }
+            int d = -2;   // empty slots go first
+            if (data) {
+                TTEntry old = ttUnpack(data);
+                d = (old.age == age) ? old.depth : -1;
+            }
+            if (d < victimDepth) { victim = i; victimDepth = d; }
+        }
+        uint64_t data = ttPack(0, e);
+        b.slot[victim].keyXorData.store(key ^ data, std::memory_order_relaxed);
+        b.slot[victim].data.store(data, std::memory_order_relaxed);
+        return !same && victimDepth != -2;
+    }
+
+    // share of slots in use, sampled over the first 1000 buckets
+    double fillRate() const {
+        if (!buckets) return 0.0;
+        size_t sample = (mask + 1 < 1000) ? mask + 1 : 1000;
+        size_t used = 0;
+        for (size_t i = 0; i < sample; ++i)
+            for (const auto &s : buckets[i].slot)
+                if (s.data.load(std::memory_order_relaxed)) ++used;
+        return double(used) / double(sample * STT_BUCKET_SLOTS);
+    }
+
+    static uint64_t mix(uint64_t k) {
+        k ^= k >> 30; k *= 0xBF58476D1CE4E5B9ULL;
+        k ^= k >> 27; k *= 0x94D049BB133111EBULL;
+        k ^= k >> 31;
+        return k;
+    }
+
+private:
+    std::unique_ptr<SharedTTBucket[]> buckets;
+    size_t mask = 0;
+    std::atomic<int> generation{0};
+};
+
+class TranspositionTable {
+public:
+    TTStats stats;
+
+    TranspositionTable() {}
+    explicit TranspositionTable(size_t sizeMB, bool hugePages = false) { resize(sizeMB, hugePages); }
+    ~TranspositionTable() { release(); }
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+    // allocate the largest power-of-two bucket count that fits in sizeMB.
+    // 0 MB disables the table. with hugePages set, Linux builds first try
+    // explicit huge pages and fall back to a transparent huge page hint.
+    void resize(size_t sizeMB, bool hugePages = false) {
+        release();
+        shared = nullptr;
+        stats = TTStats();
+        if (sizeMB == 0) return;
+
+        size_t n = 1;
+        while (n * 2 * sizeof(TTBucket) <= sizeMB * 1024 * 1024) n *= 2;
+        bytes = n * sizeof(TTBucket);
+        buckets = allocate(bytes, hugePages);
+        if (!buckets) { bytes = 0; return; }
+        mask = n - 1;
+    }
+
+    // route probes and stores to a table shared with other threads
+    // (nullptr detaches); this thread's stats are still kept here
+    void attach(SharedTranspositionTable *table) {
+        release();
+        stats = TTStats();
+        shared = table;
+    }
+    SharedTranspositionTable *sharedTable() const { return shared; }
+
+    bool enabled() const { return buckets != nullptr || shared != nullptr; }
+    size_t sizeBytes() const { return shared ? shared->sizeBytes() : bytes; }
+    bool usingHugePages() const { return onHugePages; }
+
+    void clear() {
+        if (buckets) memset(buckets, 0, bytes);
+        generation = 0;
+    }
+
+    // call once per root search so older entries can be told apart
+    void newSearch() {
+        if (shared) shared->newSearch();
+        generation = (generation + 1) & 0xFF;
+    }
+
+    bool probe(uint64_t key, TTEntry &out) {
+        ++stats.probes;
+        if (shared) {
+            if (!shared->probe(key, out)) return false;
+            ++stats.hits;
+            return true;
+        }
+        uint64_t h = mix(key);
+        uint32_t check = uint32_t(h >> 40);
+        TTBucket &b = buckets[h & mask];
+        for (int i = 0; i < TT_BUCKET_SLOTS; ++i) {
+            uint64_t w = b.slot[i];
+            if (w && ttCheck(w) == check && ttUnpack(w).bound != BOUND_NONE) {
+                out = ttUnpack(w);
+                ++stats.hits;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(uint64_t key, int score, int depth, TTBound bound, int move) {
+        ++stats.stores;
+        if (shared) {
+            if (shared->store(key, score, depth, bound, move)) ++stats.depthReplaced;
+            return;
+        }
+        uint64_t h = mix(key);
+        uint32_t check = uint32_t(h >> 40);
+        TTBucket &b = buckets[h & mask];
+        TTEntry e;
+        e.score = score;
+        e.depth = depth < 63 ? depth : 63;
+        e.bound = bound;
+        e.move  = move;
+        e.age   = generation;
+
+        // same position already stored: refresh it in place unless that
+        // would throw away a deeper result from this search
+        for (int i = 0; i < TT_BUCKET_SLOTS; ++i) {
+            uint64_t w = b.slot[i];
+            if (w && ttCheck(w) == check) {
+                TTEntry old = ttUnpack(w);
+                if (i < TT_DEPTH_SLOTS && old.age == generation && old.depth > depth
+                    && bound != BOUND_EXACT)
+                    return;
+                if (e.move < 0) e.move = old.move;
+                b.slot[i] = ttPack(check, e);
+                return;
+            }
+        }
+
+        // depth-preferred tier: the victim is the shallowest slot, with
+        // entries from older searches counting as shallowest of all
+        int victim = 0, victimDepth = 1 << 30;
+        for (int i = 0; i < TT_DEPTH_SLOTS; ++i) {
+            uint64_t w = b.slot[i];
+            if (!w) { victim = i; victimDepth = -1; break; }
+            TTEntry old = ttUnpack(w);
+            int d = (old.age == generation) ? old.depth : -1;
+            if (d < victimDepth) { victim = i; victimDepth = d; }
+        }
+        if (depth >= victimDepth) {
+            if (b.slot[victim]) ++stats.depthReplaced;
+            b.slot[victim] = ttPack(check, e);
+            return;
+        }
+
+        // always-replace tier, rotated by key so neighbours spread out
+        int slot = TT_DEPTH_SLOTS + int((h >> 32) % (TT_BUCKET_SLOTS - TT_DEPTH_SLOTS));
+        if (b.slot[slot]) ++stats.alwaysReplaced;
+        b.slot[slot] = ttPack(check, e);
+    }
+
+    // share of slots in use, sampled over the first 1000 buckets
+    double fillRate() const {
+        if (shared) return shared->fillRate();
+        if (!buckets) return 0.0;
+        size_t sample = (mask + 1 < 1000) ? mask + 1 : 1000;
+        size_t used = 0;
+        for (size_t i = 0; i < sample; ++i)
+            for (int j = 0; j < TT_BUCKET_SLOTS; ++j) {
+                uint64_t w = buckets[i].slot[j];
+                if (w) ++used;
+            }
+        return double(used) / double(sample * TT_BUCKET_SLOTS);
+    }
+
+private:
+    SharedTranspositionTable *shared = nullptr;
+    TTBucket *buckets = nullptr;
+    size_t   bytes = 0;
+    size_t   mask = 0;
+    int      generation = 0;
+    bool     onHugePages = false;
+    bool     mapped = false;
+
+    // splitmix64 finalizer: board keys are sparse, so spread them first
+    static uint64_t mix(uint64_t k) {
+        k ^= k >> 30; k *= 0xBF58476D1CE4E5B9ULL;
+        k ^= k >> 27; k *= 0x94D049BB133111EBULL;
+        k ^= k >> 31;
+        return k;
+    }
+
+    TTBucket *allocate(size_t size, bool hugePages) {
+        onHugePages = false;
+#ifdef __linux__
+        void *p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (hugePages) {
+            p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            onHugePages = (p != MAP_FAILED);
+        }
+#endif
+        if (p == MAP_FAILED)
+            p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return nullptr;
+#ifdef MADV_HUGEPAGE
+        if (hugePages && !onHugePages) madvise(p, size, MADV_HUGEPAGE);
+#endif
+        mapped = true;
+        return static_cast<TTBucket *>(p);  // anonymous maps come zeroed
+#else
+        (void)hugePages;
+        void *p = aligned_alloc(64, size);
+        if (p) memset(p, 0, size);
+        mapped = false;
+        return static_cast<TTBucket *>(p);
+#endif
+    }
+
+    void release() {
+        if (!buckets) return;
+#ifdef __linux__
+        if (mapped) munmap(buckets, bytes);
+#else
+        free(buckets);
+#endif
+        buckets = nullptr;
+        bytes = 0;
+        mask = 0;
+    }
+};
+
+// the table used by minMaxAB/bestMove, disabled until resized. each thread
+// has its own, so threads running separate games never share one, unless
+// they attach() the same SharedTranspositionTable.
+inline TranspositionTable &transpositionTable() {
+    static thread_local TranspositionTable tt;
+    return tt;
+}
+
+#endif // TRANSPOSITION_H
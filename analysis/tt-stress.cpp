@@ -0,0 +1,215 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include "instrumentation.h"
+#include "board.h"
+#include "hueristics.h"
+// globals
+thread_local uint64_t g_nodesGenerated = 0;
+thread_local uint64_t g_nodesExpanded  = 0;
+
+// stress test and scaling benchmark for SharedTranspositionTable.
+//
+// stress: every thread stores and probes keys from a small key space in a
+// tiny table, so the same slots are rewritten constantly. each key always
+// gets the same score, bound and move (only the depth varies), so any hit
+// whose fields don't belong to its key is a corrupted entry that got past
+// the xor check. the same hammering against plain (key, data) pairs is run
+// as a control, to show what the check is there for.
+//
+// scaling: probe/store throughput from 1 to N threads, lock-free against
+// one per-thread style table behind a mutex, then real searches (every
+// 3-ply opening) split over the threads with private or one shared table.
+
+using Clock = chrono::steady_clock;
+
+struct Rng {
+    uint64_t s;
+    explicit Rng(uint64_t seed) : s(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+    uint64_t next() { s ^= s << 13; s ^= s >> 7; s ^= s << 17; return s; }
+};
+
+// what a key must always come back with
+int scoreOf(uint64_t k) { return int(k % 200001) - 100000; }
+int moveOf(uint64_t k)  { return int((k >> 20) % COLS); }
+TTBound boundOf(uint64_t k) { return TTBound(1 + (k >> 30) % 3); }
+uint64_t keyOf(uint64_t i) { return SharedTranspositionTable::mix(i + 1) | 1; }
+
+// the control: same layout without the xor, key word checked directly
+class PlainPairTable {
+public:
+    explicit PlainPairTable(size_t slots) : keys(slots), datas(slots), mask(slots - 1) {}
+    bool probe(uint64_t key, TTEntry &out) const {
+        size_t i = SharedTranspositionTable::mix(key) & mask;
+        if (keys[i].load(memory_order_relaxed) != key) return false;
+        out = ttUnpack(datas[i].load(memory_order_relaxed));
+        return true;
+    }
+    void store(uint64_t key, int score, int depth, TTBound bound, int move) {
+        TTEntry e;
+        e.score = score; e.depth = depth; e.bound = bound; e.move = move;
+        size_t i = SharedTranspositionTable::mix(key) & mask;
+        keys[i].store(key, memory_order_relaxed);
+        datas[i].store(ttPack(0, e), memory_order_relaxed);
+    }
+private:
+    vector<atomic<uint64_t>> keys, datas;
+    size_t mask;
+};
+
+struct StressResult {
+    uint64_t ops = 0, hits = 0, corrupt = 0;
+};
+
+template <class Table>
+StressResult hammer(Table &table, int threads, double seconds, uint64_t keySpace) {
+    atomic<uint64_t> ops{0}, hits{0}, corrupt{0};
+    atomic<bool> stop{false};
+    auto worker = [&](int id) {
+        Rng rng(id + 1);
+        uint64_t n = 0, h = 0, bad = 0;
+        while (!stop.load(memory_order_relaxed)) {
+            for (int i = 0; i < 1024; ++i, ++n) {
+                uint64_t r = rng.next();
+                uint64_t k = keyOf(r % keySpace);
+                if (r & (uint64_t(1) << 40)) {
+                    table.store(k, scoreOf(k), int(r >> 50) % 40, boundOf(k), moveOf(k));
+                } else {
+                    TTEntry e;
+                    if (!table.probe(k, e)) continue;
+                    ++h;
+                    if (e.score != scoreOf(k) || e.move != moveOf(k) || e.bound != boundOf(k)) ++bad;
+                }
+            }
+        }
+        ops += n; hits += h; corrupt += bad;
+    };
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t) pool.emplace_back(worker, t);
+    this_thread::sleep_for(chrono::duration<double>(seconds));
+    stop = true;
+    for (auto &t : pool) t.join();
+    return {ops.load(), hits.load(), corrupt.load()};
+}
+
+// throughput in Mops/s of a 70/30 probe/store mix over a large key space
+template <class Fn>
+double throughput(int threads, uint64_t opsPerThread, Fn op) {
+    auto t0 = Clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            Rng rng(t + 101);
+            for (uint64_t i = 0; i < opsPerThread; ++i) op(rng.next());
+        });
+    for (auto &t : pool) t.join();
+    double secs = chrono::duration<double>(Clock::now() - t0).count();
+    return threads * opsPerThread / secs / 1e6;
+}
+
+vector<Board> openings3() {
+    vector<Board> out;
+    for (int a = 0; a < COLS; ++a)
+        for (int b = 0; b < COLS; ++b)
+            for (int c = 0; c < COLS; ++c) {
+                Board board;
+                board.makeMove(a, MAX_PLAYER);
+                board.makeMove(b, MIN_PLAYER);
+                board.makeMove(c, MAX_PLAYER);
+                out.push_back(board);
+            }
+    return out;
+}
+
+// every opening searched to 'depth' by 'threads' threads; returns seconds
+double searchRun(int threads, int depth, SharedTranspositionTable *shared, uint64_t &nodes) {
+    vector<Board> positions = openings3();
+    atomic<size_t> next{0};
+    atomic<uint64_t> total{0};
+    auto t0 = Clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back([&] {
+            if (shared) transpositionTable().attach(shared);
+            else transpositionTable().resize(16);
+            g_nodesGenerated = 0;
+            for (size_t i; (i = next.fetch_add(1)) < positions.size(); )
+                bestMove(positions[i], depth, MIN_PLAYER);
+            total += g_nodesGenerated;
+        });
+    for (auto &t : pool) t.join();
+    nodes = total.load();
+    return chrono::duration<double>(Clock::now() - t0).count();
+}
+
+int main(int argc, char* argv[]) {
+    int maxThreads = int(thread::hardware_concurrency());
+    double seconds = 2.0;
+    int depth = 7;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc)      maxThreads = atoi(argv[++i]);
+        else if (arg == "--seconds" && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (arg == "--depth" && i + 1 < argc)   depth = atoi(argv[++i]);
+        else {
+            cerr << "Usage: " << argv[0] << " [--threads N] [--seconds S] [--depth D]" << endl;
+            return 1;
+        }
+    }
+    if (maxThreads < 1) maxThreads = 1;
+    // oversubscribe a little so a small machine still interleaves writers
+    int stressThreads = max(maxThreads, 4);
+
+    cout << "stress: " << stressThreads << " threads, " << seconds << " s each\n";
+    SharedTranspositionTable small(1);   // 16384 buckets
+    StressResult lf = hammer(small, stressThreads, seconds, 4 * 16384 * STT_BUCKET_SLOTS);
+    PlainPairTable plain(1 << 12);
+    StressResult pp = hammer(plain, stressThreads, seconds, 1 << 13);
+    cout << left << setw(14) << "table" << setw(14) << "ops" << setw(14) << "hits" << "corrupt hits\n"
+         << setw(14) << "xor pairs" << setw(14) << lf.ops << setw(14) << lf.hits << lf.corrupt << "\n"
+         << setw(14) << "plain pairs" << setw(14) << pp.ops << setw(14) << pp.hits << pp.corrupt
+         << "   (control, no verification)\n";
+
+    cout << "\nscaling: probe/store Mops/s (70% probes) and search time, depth " << depth << "\n"
+         << setw(9) << "threads" << setw(12) << "lockfree" << setw(12) << "mutex"
+         << setw(14) << "private(s)" << setw(16) << "private nodes"
+         << setw(13) << "shared(s)" << "shared nodes\n";
+    SharedTranspositionTable big(64);
+    TranspositionTable locked(64);
+    mutex lockedMtx;
+    const uint64_t opsPerThread = 2000000;
+    vector<int> counts;
+    for (int t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads);
+    for (int t : counts) {
+        double lockFree = throughput(t, opsPerThread, [&](uint64_t r) {
+            uint64_t k = keyOf(r >> 8);
+            TTEntry e;
+            if (r % 10 < 7) big.probe(k, e);
+            else big.store(k, scoreOf(k), int(r >> 58), boundOf(k), moveOf(k));
+        });
+        double withMutex = throughput(t, opsPerThread, [&](uint64_t r) {
+            uint64_t k = keyOf(r >> 8);
+            TTEntry e;
+            lock_guard<mutex> lock(lockedMtx);
+            if (r % 10 < 7) locked.probe(k, e);
+            else locked.store(k, scoreOf(k), int(r >> 58), boundOf(k), moveOf(k));
+        });
+        uint64_t privNodes = 0, sharedNodes = 0;
+        double privSecs = searchRun(t, depth, nullptr, privNodes);
+        SharedTranspositionTable searchTable(16 * t);
+        double sharedSecs = searchRun(t, depth, &searchTable, sharedNodes);
+        cout << setw(9) << t << fixed << setprecision(1)
+             << setw(12) << lockFree << setw(12) << withMutex
+             << setprecision(3) << setw(14) << privSecs << setw(16) << privNodes
+             << setw(13) << sharedSecs << sharedNodes << "\n";
+    }
+    return lf.corrupt ? 1 : 0;
+}
@@ -0,0 +1,306 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include "instrumentation.h"
+#include "board.h"
+#include "engine.h"
+// globals
+thread_local uint64_t g_nodesGenerated = 0;
+thread_local uint64_t g_nodesExpanded  = 0;
+
+// texel-style tuning of the tuned evaluator (evaluateTuned):
+//   1. self-play: --games games of the engine against itself (--depth,
+//      --play-eval) on --threads threads, each from a random opening and
+//      with an occasional random move, so the positions vary. every quiet
+//      position (no immediate win, nothing to block) is kept with the
+//      game's result: 1 X won, 0.5 draw, 0 O won.
+//   2. fit: weights w so that sigmoid(w . features) predicts the result,
+//      by gradient descent (adam) on the logistic loss over all positions
+//      at once. column weights are tied in mirror pairs. every tenth game
+//      is held out to check the fit generalises.
+//   3. write the weights, scaled to integers, as a header of constexprs
+//      (--out, default tuned-weights.h) for the next build.
+// the hand-made evaluators get the same treatment with only a scale (and
+// the tempo and constant offsets) fitted, so the held-out losses compare like for like.
+
+using Clock = chrono::steady_clock;
+
+// one logit is this many evaluation points in the emitted weights
+const double POINTS_PER_LOGIT = 100.0;
+
+struct Sample {
+    EvalFeatures f;
+    bool maxToMove;
+    float result;      // for X
+    bool heldOut;
+};
+
+// true if the side to move can win at once or has to block
+bool forcing(const Board &board, char player) {
+    BitPosition pos(board, player), other(board, player);
+    other.toMove ^= 1;
+    for (int c = 0; c < COLS; ++c)
+        if (pos.canPlay(c) && (pos.isWinningMove(c) || other.isWinningMove(c))) return true;
+    return false;
+}
+
+vector<Sample> selfPlay(int games, int threads, const EngineSettings &engine, double randomRate,
+                        size_t ttMB, unsigned seed) {
+    vector<Sample> all;
+    mutex mtx;
+    atomic<int> next{0};
+    auto worker = [&] {
+        transpositionTable().resize(ttMB);
+        vector<Sample> mine;
+        for (int g; (g = next.fetch_add(1)) < games; ) {
+            mt19937 rng(seed * 7919u + g);
+            Board board;
+            char player = MAX_PLAYER;
+            int opening = 2 + rng() % 7;
+            size_t first = mine.size();
+            for (int ply = 0; ; ++ply) {
+                bool random = ply < opening || (rng() % 1000) < randomRate * 1000;
+                if (ply >= opening && !forcing(board, player))
+                    mine.push_back({evalFeatures(board), player == MAX_PLAYER, 0.5f, g % 10 == 0});
+                int col;
+                if (random) {
+                    do col = rng() % COLS; while (!board.isValidMove(col));
+                } else {
+                    col = engineMove(board, player, engine).col;
+                }
+                board.makeMove(col, player);
+                if (board.checkWin(player) || board.isFull()) break;
+                player = (player == MAX_PLAYER) ? MIN_PLAYER : MAX_PLAYER;
+            }
+            float result = board.checkWin(MAX_PLAYER) ? 1.0f : board.checkWin(MIN_PLAYER) ? 0.0f : 0.5f;
+            for (size_t i = first; i < mine.size(); ++i) mine[i].result = result;
+        }
+        lock_guard<mutex> lock(mtx);
+        all.insert(all.end(), mine.begin(), mine.end());
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool) t.join();
+    return all;
+}
+
+// a feature matrix stored by column, so every pass over the positions is a
+// plain loop over contiguous floats
+struct Dataset {
+    vector<vector<float>> cols;
+    vector<float> y;
+    size_t size() const { return y.size(); }
+};
+
+typedef vector<float> (*FeatureFn)(const Sample &);
+
+Dataset makeDataset(const vector<Sample> &samples, bool heldOut, FeatureFn fn) {
+    Dataset d;
+    for (const Sample &s : samples) {
+        if (s.heldOut != heldOut) continue;
+        vector<float> x = fn(s);
+        if (d.cols.empty()) d.cols.resize(x.size());
+        for (size_t j = 0; j < x.size(); ++j) d.cols[j].push_back(x[j]);
+        d.y.push_back(s.result);
+    }
+    return d;
+}
+
+// the tuned evaluator's inputs: mirror-pair columns, gap, threats, tempo
+// and a constant. X moves first, so the piece count already says whose
+// turn it is; with the tempo input both sides to move get their own offset.
+// the column inputs add up to that piece count, so a level shared by every
+// column is the same thing as the constant and tempo together: fitted
+// freely it soaked up X's first-move edge and left the columns flat. the
+// edge pair is left out instead (weight 0) and the others are relative to it
+const int HALF = (COLS + 1) / 2;
+const int COL_INPUTS = HALF - 1;
+vector<float> tunedFeatures(const Sample &s) {
+    vector<float> x;
+    for (int k = 1; k < HALF; ++k)
+        x.push_back(float(s.f.colPieces[k] + (COLS - 1 - k != k ? s.f.colPieces[COLS - 1 - k] : 0)));
+    x.push_back(float(s.f.gap));
+    x.push_back(float(s.f.oddThreats));
+    x.push_back(float(s.f.evenThreats));
+    x.push_back(s.maxToMove ? 1.0f : -1.0f);
+    x.push_back(1.0f);
+    return x;
+}
+
+// the hand-made evaluators as a single input each (only a scale is
+// fitted), plus the same tempo and constant inputs
+vector<float> centerFeature(const Sample &s) {
+    float v = 0;
+    for (int c = 0; c < COLS; ++c) v += colWeight[c] * s.f.colPieces[c];
+    return {v, s.maxToMove ? 1.0f : -1.0f, 1.0f};
+}
+
+vector<float> sparseFeature(const Sample &s) {
+    float v = float(s.f.gap);
+    for (int c = 0; c < COLS; ++c) v += s.f.colPieces[c];
+    return {v, s.maxToMove ? 1.0f : -1.0f, 1.0f};
+}
+
+// w . x for every position
+void scores(const Dataset &d, const vector<double> &w, vector<float> &z) {
+    z.assign(d.size(), 0.0f);
+    for (size_t j = 0; j < d.cols.size(); ++j) {
+        const float *x = d.cols[j].data();
+        float wj = float(w[j]);
+        float *out = z.data();
+        for (size_t i = 0, n = d.size(); i < n; ++i) out[i] += wj * x[i];
+    }
+}
+
+double logLoss(const Dataset &d, const vector<double> &w) {
+    vector<float> z;
+    scores(d, w, z);
+    double loss = 0;
+    for (size_t i = 0; i < d.size(); ++i) {
+        // log(1 + e^-z) and log(1 + e^z), written to stay finite
+        double lp = z[i] > 0 ? log1p(exp(-z[i])) : -z[i] + log1p(exp(z[i]));
+        double ln = lp + z[i];
+        loss += d.y[i] * lp + (1 - d.y[i]) * ln;
+    }
+    return d.size() ? loss / d.size() : 0;
+}
+
+// adam on the mean logistic loss, full batch
+vector<double> fit(const Dataset &d, int iters, double rate) {
+    size_t nw = d.cols.size(), n = d.size();
+    vector<double> w(nw, 0.0), m(nw, 0.0), v(nw, 0.0);
+    vector<float> z, err(n);
+    const double b1 = 0.9, b2 = 0.999;
+    for (int it = 1; it <= iters; ++it) {
+        scores(d, w, z);
+        for (size_t i = 0; i < n; ++i) err[i] = 1.0f / (1.0f + exp(-z[i])) - d.y[i];
+        for (size_t j = 0; j < nw; ++j) {
+            const float *x = d.cols[j].data();
+            double g = 0;
+            for (size_t i = 0; i < n; ++i) g += err[i] * x[i];
+            g /= n;
+            m[j] = b1 * m[j] + (1 - b1) * g;
+            v[j] = b2 * v[j] + (1 - b2) * g * g;
+            double mh = m[j] / (1 - pow(b1, it)), vh = v[j] / (1 - pow(b2, it));
+            w[j] -= rate * mh / (sqrt(vh) + 1e-9);
+        }
+    }
+    return w;
+}
+
+bool writeHeader(const string &path, const vector<int> &iw, const string &note) {
+    ofstream out(path);
+    if (!out) return false;
+    out << "// tuned-weights.h\n"
+        << "// generated by tune-main; rerun it rather than editing by hand\n"
+        << "#ifndef TUNED_WEIGHTS_H\n#define TUNED_WEIGHTS_H\n\n"
+        << "// " << note << "\n"
+        << "constexpr int TUNED_ROWS = " << ROWS << ", TUNED_COLS = " << COLS << ";\n"
+        << "constexpr int tunedColWeight[TUNED_COLS] = {";
+    for (int c = 0; c < COLS; ++c) {
+        int k = min(c, COLS - 1 - c);
+        out << (c ? ", " : "") << (k ? iw[k - 1] : 0);
+    }
+    out << "};\n"
+        << "constexpr int tunedGapWeight = " << iw[COL_INPUTS] << ";\n"
+        << "constexpr int tunedOddThreat = " << iw[COL_INPUTS + 1] << ";\n"
+        << "constexpr int tunedEvenThreat = " << iw[COL_INPUTS + 2] << ";\n"
+        << "constexpr int tunedTempo = " << iw[COL_INPUTS + 3] << ";\n"
+        << "constexpr int tunedBias = " << iw[COL_INPUTS + 4] << ";\n"
+        << "\n#endif // TUNED_WEIGHTS_H\n";
+    return bool(out);
+}
+
+int main(int argc, char* argv[]) {
+    int games = 2000, threads = int(thread::hardware_concurrency()), iters = 3000;
+    double randomRate = 0.1, rate = 0.05;
+    size_t ttMB = 16;
+    unsigned seed = 1;
+    string outPath = "tuned-weights.h";
+    EngineSettings engine;
+    engine.depth = 4;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool more = i + 1 < argc;
+        if (arg == "--games" && more)             games = atoi(argv[++i]);
+        else if (arg == "--threads" && more)      threads = atoi(argv[++i]);
+        else if (arg == "--depth" && more)        engine.depth = atoi(argv[++i]);
+        else if (arg == "--random" && more)       randomRate = atof(argv[++i]);
+        else if (arg == "--iters" && more)        iters = atoi(argv[++i]);
+        else if (arg == "--rate" && more)         rate = atof(argv[++i]);
+        else if (arg == "--tt-mb" && more)        ttMB = atol(argv[++i]);
+        else if (arg == "--seed" && more)         seed = unsigned(atol(argv[++i]));
+        else if (arg == "--out" && more)          outPath = argv[++i];
+        else if (arg == "--play-eval" && more && parseEvalKind(argv[i+1], engine.eval)) ++i;
+        else {
+            cerr << "Usage: " << argv[0] << " [--games N] [--threads N] [--depth D]"
+                 << " [--play-eval side|center|sparse|tuned] [--random P] [--iters N] [--rate R]"
+                 << " [--tt-mb N] [--seed S] [--out FILE]" << endl;
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+
+    auto t0 = Clock::now();
+    vector<Sample> samples = selfPlay(games, threads, engine, randomRate, ttMB, seed);
+    double playSecs = chrono::duration<double>(Clock::now() - t0).count();
+    cout << games << " self-play games (" << engineSpecString(engine) << ", " << threads
+         << " threads): " << samples.size() << " quiet positions in " << fixed << setprecision(1)
+         << playSecs << " s\n";
+
+    Dataset train = makeDataset(samples, false, tunedFeatures);
+    Dataset test  = makeDataset(samples, true, tunedFeatures);
+    if (train.size() == 0 || test.size() == 0) { cerr << "not enough positions" << endl; return 1; }
+
+    t0 = Clock::now();
+    vector<double> w = fit(train, iters, rate);
+    double fitSecs = chrono::duration<double>(Clock::now() - t0).count();
+    vector<int> iw;
+    vector<double> rounded;
+    for (double x : w) {
+        iw.push_back(int(lround(x * POINTS_PER_LOGIT)));
+        rounded.push_back(iw.back() / POINTS_PER_LOGIT);
+    }
+
+    // the hand-made evaluators, scale only
+    Dataset centerTrain = makeDataset(samples, false, centerFeature);
+    Dataset centerTest  = makeDataset(samples, true, centerFeature);
+    Dataset sparseTrain = makeDataset(samples, false, sparseFeature);
+    Dataset sparseTest  = makeDataset(samples, true, sparseFeature);
+    double centerLoss = logLoss(centerTest, fit(centerTrain, iters, rate));
+    double sparseLoss = logLoss(sparseTest, fit(sparseTrain, iters, rate));
+    double tunedLoss = logLoss(test, rounded);
+    double constLoss = logLoss(test, vector<double>(w.size(), 0.0));
+
+    cout << "fit: " << train.size() << " training, " << test.size() << " held-out positions, "
+         << iters << " iterations in " << setprecision(2) << fitSecs << " s\n"
+         << "held-out logistic loss: tuned " << setprecision(4) << tunedLoss
+         << ", center bias " << centerLoss << ", sparse bias " << sparseLoss
+         << ", no evaluator " << constLoss << "\n"
+         << "weights (points): columns 0";
+    for (int k = 0; k < COL_INPUTS; ++k) cout << " " << iw[k];
+    cout << ", gap " << iw[COL_INPUTS] << ", odd threats " << iw[COL_INPUTS + 1]
+         << ", even threats " << iw[COL_INPUTS + 2] << ", tempo " << iw[COL_INPUTS + 3]
+         << ", bias " << iw[COL_INPUTS + 4] << "\n";
+
+    stringstream note;
+    note << train.size() + test.size() << " positions from " << games << " games at depth "
+         << engine.depth << "; held-out loss " << setprecision(4) << tunedLoss
+         << " (center bias " << centerLoss << ", sparse bias " << sparseLoss << ")";
+    if (!writeHeader(outPath, iw, note.str())) { cerr << "could not write " << outPath << endl; return 1; }
+    cout << "wrote " << outPath << "\n";
+    return 0;
+}
@@ -0,0 +1,15 @@
+// tuned-weights.h
+// generated by tune-main; rerun it rather than editing by hand
+#ifndef TUNED_WEIGHTS_H
+#define TUNED_WEIGHTS_H
+
+// 40571 positions from 3000 games at depth 4; held-out loss 0.6028 (center bias 0.6115, sparse bias 0.6108)
+constexpr int TUNED_ROWS = 6, TUNED_COLS = 7;
+constexpr int tunedColWeight[TUNED_COLS] = {0, 4, -1, 0, -1, 4, 0};
+constexpr int tunedGapWeight = 0;
+constexpr int tunedOddThreat = 20;
+constexpr int tunedEvenThreat = 23;
+constexpr int tunedTempo = 4;
+constexpr int tunedBias = 78;
+
+#endif // TUNED_WEIGHTS_H
@@ -0,0 +1,253 @@
+// watchdog.h
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <mutex>
+#include <unordered_set>
+#include "board.h"
+#include "instrumentation.h"
+#include "evalcache.h"
+#include "transposition.h"
+#include "book.h"
+#include "poscache.h"
+#include "tablebase.h"
+#include "pnsearch.h"
+
+// slow-search capture: every search that runs longer than a time or node
+// threshold is appended to a log as one line of key=value fields, enough
+// to set the case up again and replay it (replay-main):
+//
+//   ms=812.4 nodes=1934211 expanded=402113 tt-probes=... tt-hits=...
+//   eval-probes=... eval-hits=... threat-nodes=... player=X moves=3342...
+//   spec=engine=minmax,depth=9,... iterative=1 node-limit=0 multipv=1
+//   stopped=0 dfpn=0 dfpn-mb=4 tt-mb=16 book=- cache=- tablebase=-
+//   reached=9 col=3 score=12
+//
+// the position is stored as the column sequence that reaches it from the
+// empty board (X first), the settings as an engine spec (engine.h) plus
+// the process-wide ones that change the search (df-pn precheck, table
+// size, the book, cache and tablebase files), and the counters are the
+// ones the search added on its own thread. lines starting
+// with '#' are comments. one log per process, shared by all threads.
+
+struct SlowCase {
+    double ms = 0;
+    uint64_t nodes = 0, expanded = 0;
+    uint64_t ttProbes = 0, ttHits = 0;
+    uint64_t evalProbes = 0, evalHits = 0;
+    uint64_t threatNodes = 0;
+    char player = MAX_PLAYER;
+    string moves;          // columns as digits, e.g. "3342"
+    string spec;           // engine spec, parseEngineSpec() reads it back
+    bool iterative = false;  // deepened 1, 2, ... (bestMoveWithin), not one bestMove
+    uint64_t nodeLimit = 0;
+    int multiPV = 1;       // root moves scored exactly (multiPV) when above 1
+    bool stopped = false;  // cut short by a stop request, so 'nodes' is all it got
+    uint64_t dfpnNodes = 0;  // dfpnPrecheck() budget and table size
+    size_t dfpnMB = 4;
+    long ttMB = -1;        // transposition table size, -1 when not recorded
+    string book, cache, tablebase;   // files consulted, empty for none
+    int reached = 0;       // deepest finished iteration (0 for mcts)
+    int col = -1, score = 0;
+};
+
+// a column sequence that reaches 'board' from the empty board, X moving
+// first and nobody winning before the end; false if there is none (the
+// board is not a reachable position). unplays top pieces of the last mover
+// depth-first, remembering positions that lead nowhere.
+inline bool moveSequence(const Board &board, string &moves) {
+    Board b = board;
+    int pieces = 0;
+    for (int r = 0; r < ROWS; ++r)
+        for (int c = 0; c < COLS; ++c) pieces += b.grid[r][c] != EMPTY;
+    unordered_set<uint64_t> deadEnds;
+    vector<int> cols;
+    auto unplay = [&](auto &&self, int n) -> bool {
+        if (n == 0) return true;
+        if (deadEnds.count(b.key())) return false;
+        char last = (n % 2 == 1) ? MAX_PLAYER : MIN_PLAYER;
+        for (int c = 0; c < COLS; ++c) {
+            int top = 0;
+            while (top < ROWS && b.grid[top][c] == EMPTY) ++top;
+            if (top == ROWS || b.grid[top][c] != last) continue;
+            b.undoMove(c);
+            bool ok = !b.checkWin(MAX_PLAYER) && !b.checkWin(MIN_PLAYER) && self(self, n - 1);
+            b.makeMove(c, last);
+            if (ok) { cols.push_back(c); return true; }
+        }
+        deadEnds.insert(b.key());
+        return false;
+    };
+    if (!unplay(unplay, pieces)) return false;
+    moves.clear();
+    for (int c : cols) moves += char('0' + c);
+    return true;
+}
+
+// replays a move string onto an empty board; false on an illegal column
+inline bool playMoves(const string &moves, Board &board, char &player) {
+    board = Board();
+    player = MAX_PLAYER;
+    for (char ch : moves) {
+        int c = ch - '0';
+        if (c < 0 || c >= COLS || !board.isValidMove(c)) return false;
+        board.makeMove(c, player);
+        player = (player == MAX_PLAYER) ? MIN_PLAYER : MAX_PLAYER;
+    }
+    return true;
+}
+
+inline string formatSlowCase(const SlowCase &s) {
+    stringstream ss;
+    ss.setf(std::ios::fixed);
+    ss.precision(1);
+    ss << "ms=" << s.ms << " nodes=" << s.nodes << " expanded=" << s.expanded
+       << " tt-probes=" << s.ttProbes << " tt-hits=" << s.ttHits
+       << " eval-probes=" << s.evalProbes << " eval-hits=" << s.evalHits
+       << " threat-nodes=" << s.threatNodes << " player=" << s.player
+       << " moves=" << (s.moves.empty() ? "-" : s.moves) << " spec=" << s.spec
+       << " iterative=" << s.iterative << " node-limit=" << s.nodeLimit
+       << " multipv=" << s.multiPV << " stopped=" << s.stopped
+       << " dfpn=" << s.dfpnNodes << " dfpn-mb=" << s.dfpnMB << " tt-mb=" << s.ttMB
+       << " book=" << (s.book.empty() ? "-" : s.book)
+       << " cache=" << (s.cache.empty() ? "-" : s.cache)
+       << " tablebase=" << (s.tablebase.empty() ? "-" : s.tablebase)
+       << " reached=" << s.reached
+       << " col=" << s.col << " score=" << s.score;
+    return ss.str();
+}
+
+// false for comments, blank lines and lines missing the position or spec
+inline bool parseSlowCase(const string &line, SlowCase &s) {
+    if (line.empty() || line[0] == '#') return false;
+    s = SlowCase();
+    bool haveMoves = false, haveSpec = false;
+    stringstream ss(line);
+    string field;
+    while (ss >> field) {
+        size_t eq = field.find('=');
+        if (eq == string::npos) return false;
+        string key = field.substr(0, eq), val = field.substr(eq + 1);
+        const char *v = val.c_str();
+        if (key == "ms")                s.ms = atof(v);
+        else if (key == "nodes")        s.nodes = strtoull(v, nullptr, 10);
+        else if (key == "expanded")     s.expanded = strtoull(v, nullptr, 10);
+        else if (key == "tt-probes")    s.ttProbes = strtoull(v, nullptr, 10);
+        else if (key == "tt-hits")      s.ttHits = strtoull(v, nullptr, 10);
+        else if (key == "eval-probes")  s.evalProbes = strtoull(v, nullptr, 10);
+        else if (key == "eval-hits")    s.evalHits = strtoull(v, nullptr, 10);
+        else if (key == "threat-nodes") s.threatNodes = strtoull(v, nullptr, 10);
+        else if (key == "player")       s.player = val.empty() ? MAX_PLAYER : val[0];
+        else if (key == "moves")        { s.moves = (val == "-") ? "" : val; haveMoves = true; }
+        else if (key == "spec")         { s.spec = val; haveSpec = true; }
+        else if (key == "iterative")    s.iterative = atoi(v) != 0;
+        else if (key == "node-limit")   s.nodeLimit = strtoull(v, nullptr, 10);
+        else if (key == "multipv")      s.multiPV = atoi(v);
+        else if (key == "stopped")      s.stopped = atoi(v) != 0;
+        else if (key == "dfpn")         s.dfpnNodes = strtoull(v, nullptr, 10);
+        else if (key == "dfpn-mb")      s.dfpnMB = strtoull(v, nullptr, 10);
+        else if (key == "tt-mb")        s.ttMB = atol(v);
+        else if (key == "book")         s.book = (val == "-") ? "" : val;
+        else if (key == "cache")        s.cache = (val == "-") ? "" : val;
+        else if (key == "tablebase")    s.tablebase = (val == "-") ? "" : val;
+        else if (key == "reached")      s.reached = atoi(v);
+        else if (key == "col")          s.col = atoi(v);
+        else if (key == "score")        s.score = atoi(v);
+        // unknown keys are skipped, so older readers take newer logs
+    }
+    return haveMoves && haveSpec;
+}
+
+// this thread's counters before a search, to take the search's share after it
+struct SearchSnapshot {
+    uint64_t nodes, expanded, ttProbes, ttHits, evalProbes, evalHits, threatNodes;
+
+    static SearchSnapshot take() {
+        const TTStats &tt = transpositionTable().stats;
+        return {g_nodesGenerated, g_nodesExpanded, tt.probes, tt.hits,
+                evalCache().probes, evalCache().hits, threatCounters().nodes};
+    }
+};
+
+class SlowSearchLog {
+public:
+    double thresholdMs = 0;       // capture searches at least this slow ...
+    uint64_t thresholdNodes = 0;  // ... or this many nodes; 0 = not this test
+
+    // append to 'path'; false if it cannot be opened
+    bool open(const string &path) {
+        lock_guard<mutex> lock(mtx);
+        if (file) fclose(file);
+        file = fopen(path.c_str(), "a");
+        return file != nullptr;
+    }
+
+    ~SlowSearchLog() { if (file) fclose(file); }
+
+    bool enabled() const { return file && (thresholdMs > 0 || thresholdNodes > 0); }
+    uint64_t captured() const { return count; }
+
+    // one finished search: logged if it crossed a threshold. 'board' is the
+    // position searched (before the move), 'before' taken just ahead of it.
+    void check(const Board &board, char player, const string &spec, bool iterative, uint64_t nodeLimit,
+               int multiPV, bool stopped, const SearchSnapshot &before, double ms, int reached,
+               const Move &mv, int score) {
+        if (!enabled()) return;
+        uint64_t nodes = g_nodesGenerated - before.nodes;
+        bool slow = (thresholdMs > 0 && ms >= thresholdMs)
+                 || (thresholdNodes > 0 && nodes >= thresholdNodes);
+        if (!slow) return;
+        SearchSnapshot after = SearchSnapshot::take();
+        SlowCase s;
+        s.ms = ms;
+        s.nodes = nodes;
+        s.expanded = after.expanded - before.expanded;
+        s.ttProbes = after.ttProbes - before.ttProbes;
+        s.ttHits = after.ttHits - before.ttHits;
+        s.evalProbes = after.evalProbes - before.evalProbes;
+        s.evalHits = after.evalHits - before.evalHits;
+        s.threatNodes = after.threatNodes - before.threatNodes;
+        s.player = player;
+        if (!moveSequence(board, s.moves)) s.moves = "?";
+        s.spec = spec;
+        s.iterative = iterative;
+        s.nodeLimit = nodeLimit;
+        s.multiPV = multiPV;
+        s.stopped = stopped;
+        s.dfpnNodes = dfpnPrecheck().nodes;
+        s.dfpnMB = dfpnPrecheck().tableMB;
+        s.ttMB = long((transpositionTable().sizeBytes() + (1 << 20) - 1) >> 20);
+        s.book = openingBook().filePath();
+        if (positionCache().enabled()) s.cache = positionCache().filePath();
+        s.tablebase = tablebase().filePath();
+        s.reached = reached;
+        s.col = mv.col;
+        s.score = score;
+        string line = formatSlowCase(s);
+        lock_guard<mutex> lock(mtx);
+        if (!file) return;
+        fputs(line.c_str(), file);
+        fputc('\n', file);
+        fflush(file);
+        ++count;
+    }
+
+private:
+    FILE *file = nullptr;
+    mutex mtx;
+    uint64_t count = 0;
+};
+
+// the process-wide log; off until a driver opens it and sets a threshold
+inline SlowSearchLog &slowSearchLog() {
+    static SlowSearchLog log;
+    return log;
+}
+
+#endif // WATCHDOG_H